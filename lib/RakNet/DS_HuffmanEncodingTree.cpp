@@ -69,7 +69,7 @@ void HuffmanEncodingTree::FreeMemory( void )
 ////#include <stdio.h>
 
 // Given a frequency table of 256 elements, all with a frequency of 1 or more, generate the tree
-void HuffmanEncodingTree::GenerateFromFrequencyTable( unsigned int frequencyTable[ 256 ] )
+void HuffmanEncodingTree::GenerateFromFrequencyTable( const unsigned int frequencyTable[ 256 ] )
 {
 	int counter;
 	HuffmanEncodingTreeNode * node;
@@ -153,6 +153,8 @@ void HuffmanEncodingTree::GenerateFromFrequencyTable( unsigned int frequencyTabl
 		
 		while ( currentNode != root );
 		
+		encodingTable[ counter ].code = 0;
+		
 		// Write to the bitstream in the reverse order that we stored the path, which gives us the correct order from the root to the leaf
 		while ( tempPathLength-- > 0 )
 		{
@@ -160,6 +162,8 @@ void HuffmanEncodingTree::GenerateFromFrequencyTable( unsigned int frequencyTabl
 				bitStream.Write1();
 			else
 				bitStream.Write0();
+			
+			encodingTable[ counter ].code = ( encodingTable[ counter ].code << 1 ) | tempPath[ tempPathLength ];
 		}
 		
 		// Read data from the bitstream, which is written to the encoding table in bits and bitlength. Note this function allocates the encodingTable[counter].encoding pointer
@@ -171,7 +175,7 @@ void HuffmanEncodingTree::GenerateFromFrequencyTable( unsigned int frequencyTabl
 }
 
 // Pass an array of bytes to array and a preallocated BitStream to receive the output
-void HuffmanEncodingTree::EncodeArray( unsigned char *input, unsigned sizeInBytes, BitStream * output )
+void HuffmanEncodingTree::EncodeArray( const unsigned char *input, unsigned sizeInBytes, BitStream * output ) const
 {		
 	unsigned counter;
 	
@@ -202,7 +206,106 @@ void HuffmanEncodingTree::EncodeArray( unsigned char *input, unsigned sizeInByte
 	}
 }
 
-unsigned HuffmanEncodingTree::DecodeArray( BitStream * input, unsigned sizeInBits, unsigned maxCharsToWrite, unsigned char *output )
+unsigned HuffmanEncodingTree::GetEncodedBitLength( const unsigned char *input, unsigned sizeInBytes ) const
+{
+	unsigned bitLength = 0;
+	
+	for ( unsigned counter = 0; counter < sizeInBytes; counter++ )
+		bitLength += encodingTable[ input[ counter ] ].bitLength;
+		
+	// EncodeArray pads the output to a whole byte
+	return ( bitLength + 7 ) & ~7u;
+}
+
+void HuffmanEncodingTree::EncodeArrayDirect( const unsigned char *input, unsigned sizeInBytes, unsigned encodedBitLength, BitStream * output ) const
+{
+	if ( encodedBitLength == 0 )
+		return;
+		
+	const int writeOffset = output->GetNumberOfBitsUsed();
+	
+	output->AddBitsAndReallocate( encodedBitLength );
+	
+	unsigned char *destination = output->GetData() + ( writeOffset >> 3 );
+	
+	// Start with the used bits of the partial byte at the write offset, so every word is stored byte aligned
+	unsigned accumulatorBits = writeOffset & 7;
+	unsigned long long accumulator = accumulatorBits ? *destination >> ( 8 - accumulatorBits ) : 0;
+	
+	// Codes are at most MAX_ACCUMULATED_CODE_LENGTH bits, so after a store the rest always fits
+	auto append = [ & ]( unsigned long long code, unsigned bitLength )
+	{
+		if ( accumulatorBits + bitLength < 64 )
+		{
+			accumulator = ( accumulator << bitLength ) | code;
+			accumulatorBits += bitLength;
+			return;
+		}
+		
+		const unsigned restBits = accumulatorBits + bitLength - 64;
+		
+		accumulator = ( accumulator << ( bitLength - restBits ) ) | ( code >> restBits );
+		
+		for ( int shift = 56; shift >= 0; shift -= 8 )
+			*destination++ = ( unsigned char ) ( accumulator >> shift );
+			
+		accumulator = code & ( ( 1ULL << restBits ) - 1 );
+		accumulatorBits = restBits;
+	};
+	
+	unsigned bitLength = 0;
+	
+	for ( unsigned counter = 0; counter < sizeInBytes; counter++ )
+	{
+		const CharacterEncoding &characterEncoding = encodingTable[ input[ counter ] ];
+		
+		if ( characterEncoding.bitLength <= MAX_ACCUMULATED_CODE_LENGTH )
+		{
+			append( characterEncoding.code, characterEncoding.bitLength );
+		}
+		else
+		{
+			// Data is left aligned
+			for ( unsigned short bit = 0; bit < characterEncoding.bitLength; bit += 8 )
+			{
+				const unsigned chunkBits = characterEncoding.bitLength - bit < 8 ? characterEncoding.bitLength - bit : 8;
+				
+				append( characterEncoding.encoding[ bit >> 3 ] >> ( 8 - chunkBits ), chunkBits );
+			}
+		}
+		
+		bitLength += characterEncoding.bitLength;
+	}
+	
+	// Pad with the start of the same code EncodeArray uses
+	if ( bitLength % 8 != 0 )
+	{
+		const unsigned char remainingBits = ( unsigned char ) ( 8 - ( bitLength % 8 ) );
+		
+		for ( unsigned counter = 0; counter < 256; counter++ )
+			if ( encodingTable[ counter ].bitLength > remainingBits )
+			{
+				append( encodingTable[ counter ].encoding[ 0 ] >> ( 8 - remainingBits ), remainingBits );
+				break;
+			}
+	}
+	
+	// Store the last partial word, the unused bits of its last byte are 0
+	if ( accumulatorBits > 0 )
+	{
+		accumulator <<= 64 - accumulatorBits;
+		
+		for ( int shift = 56; accumulatorBits > 0; shift -= 8 )
+		{
+			*destination++ = ( unsigned char ) ( accumulator >> shift );
+			accumulatorBits = accumulatorBits > 8 ? accumulatorBits - 8 : 0;
+		}
+	}
+	
+	output->SetWriteOffset( writeOffset + encodedBitLength );
+}
+
+unsigned HuffmanEncodingTree::DecodeArray( BitStream * input, unsigned sizeInBits, unsigned maxCharsToWrite, unsigned char *output ) const
 {
 	HuffmanEncodingTreeNode * currentNode;
 	
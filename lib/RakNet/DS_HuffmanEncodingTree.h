@@ -34,13 +34,25 @@ public:
 	/// \param [in] input Array of bytes to encode
 	/// \param [in] sizeInBytes size of \a input
 	/// \param [out] output The bitstream to write to
-	void EncodeArray( unsigned char *input, unsigned sizeInBytes, BitStream * output );
+	void EncodeArray( const unsigned char *input, unsigned sizeInBytes, BitStream * output ) const;
+	
+	/// Returns the number of bits EncodeArray() writes for \a input, including the padding to a whole byte
+	/// \param [in] input Array of bytes to encode
+	/// \param [in] sizeInBytes size of \a input
+	unsigned GetEncodedBitLength( const unsigned char *input, unsigned sizeInBytes ) const;
+	
+	/// Writes the same bits as EncodeArray(), but packs the codes into a 64 bit accumulator and stores whole words straight into \a output
+	/// \param [in] input Array of bytes to encode
+	/// \param [in] sizeInBytes size of \a input
+	/// \param [in] encodedBitLength The result of GetEncodedBitLength() for \a input
+	/// \param [out] output The bitstream to write to
+	void EncodeArrayDirect( const unsigned char *input, unsigned sizeInBytes, unsigned encodedBitLength, BitStream * output ) const;
 	
 	// Decodes an array encoded by EncodeArray()
-	unsigned DecodeArray( BitStream * input, unsigned sizeInBits, unsigned maxCharsToWrite, unsigned char *output );
+	unsigned DecodeArray( BitStream * input, unsigned sizeInBits, unsigned maxCharsToWrite, unsigned char *output ) const;
 	
 	/// Given a frequency table of 256 elements, all with a frequency of 1 or more, generate the tree
-	void GenerateFromFrequencyTable( unsigned int frequencyTable[ 256 ] );
+	void GenerateFromFrequencyTable( const unsigned int frequencyTable[ 256 ] );
 	
 	/// Free the memory used by the tree
 	void FreeMemory( void );
@@ -58,8 +70,12 @@ private:
 	{
 		unsigned char* encoding;
 		unsigned short bitLength;
+		unsigned long long code; // Right aligned copy of encoding, valid if bitLength <= MAX_ACCUMULATED_CODE_LENGTH
 	};
 	
+	/// Longer codes are added to the accumulator of EncodeArrayDirect() a byte at a time
+	static const unsigned short MAX_ACCUMULATED_CODE_LENGTH = 56;
+	
 	CharacterEncoding encodingTable[ 256 ];
 	
 	void InsertNodeIntoSortedList( HuffmanEncodingTreeNode * node, std::list<HuffmanEncodingTreeNode *> *huffmanEncodingTreeNodeList ) const;
@@ -21,35 +21,6 @@
 #include <string.h>
 #include <memory.h>
 
-StringCompressor* StringCompressor::instance=0;
-int StringCompressor::referenceCount=0;
-
-void StringCompressor::AddReference(void)
-{
-	if (++referenceCount==1)
-	{
-		instance = new StringCompressor;
-	}
-}
-void StringCompressor::RemoveReference(void)
-{
-	assert(referenceCount > 0);
-
-	if (referenceCount > 0)
-	{
-		if (--referenceCount==0)
-		{
-			delete instance;
-			instance=0;
-		}
-	}
-}
-
-StringCompressor* StringCompressor::Instance(void)
-{
-	return instance;
-}
-
 unsigned int englishCharacterFrequencies[ 256 ] =
 {
 	0,
@@ -312,17 +283,44 @@ unsigned int englishCharacterFrequencies[ 256 ] =
 
 StringCompressor::StringCompressor()
 {
-	// Make a default tree immediately, since this is used for RPC possibly from multiple threads at the same time
-	huffmanEncodingTree = new HuffmanEncodingTree;
-	huffmanEncodingTree->GenerateFromFrequencyTable( englishCharacterFrequencies );
+	huffmanEncodingTrees[ 0 ].reset( new HuffmanEncodingTree );
+	huffmanEncodingTrees[ 0 ]->GenerateFromFrequencyTable( englishCharacterFrequencies );
+}
+
+StringCompressor::StringCompressor( const std::map<int, std::array<unsigned int, 256>> &frequencyTables ) : StringCompressor()
+{
+	for ( const auto &frequencyTable : frequencyTables )
+	{
+		if ( frequencyTable.first == 0 )
+			continue;
+
+		std::unique_ptr<HuffmanEncodingTree> &huffmanEncodingTree = huffmanEncodingTrees[ frequencyTable.first ];
+
+		huffmanEncodingTree.reset( new HuffmanEncodingTree );
+		huffmanEncodingTree->GenerateFromFrequencyTable( frequencyTable.second.data() );
+	}
 }
 
 StringCompressor::~StringCompressor()
 {
-	delete huffmanEncodingTree;
 }
 
-void StringCompressor::EncodeString( const char *input, int maxCharsToWrite, BitStream *output, int languageID )
+bool StringCompressor::HasTree( int languageID ) const
+{
+	return GetTree( languageID ) != 0;
+}
+
+const HuffmanEncodingTree *StringCompressor::GetTree( int languageID ) const
+{
+	auto iter = huffmanEncodingTrees.find( languageID );
+
+	if ( iter == huffmanEncodingTrees.end() )
+		return 0;
+
+	return iter->second.get();
+}
+
+void StringCompressor::EncodeString( const char *input, int maxCharsToWrite, BitStream *output, int languageID ) const
 {
 	if ( input == 0 )
 	{
@@ -330,9 +328,10 @@ void StringCompressor::EncodeString( const char *input, int maxCharsToWrite, Bit
 		return;
 	}
 
-	BitStream encodedBitStream;
+	const HuffmanEncodingTree *huffmanEncodingTree = GetTree( languageID );
 
-	unsigned short stringBitLength;
+	if ( huffmanEncodingTree == 0 )
+		return;
 
 	int charsToWrite;
 
@@ -341,7 +340,23 @@ void StringCompressor::EncodeString( const char *input, int maxCharsToWrite, Bit
 	else
 		charsToWrite = maxCharsToWrite - 1;
 
-	huffmanEncodingTree->EncodeArray( ( unsigned char* ) input, charsToWrite, &encodedBitStream );
+	const unsigned encodedBitLength = huffmanEncodingTree->GetEncodedBitLength( ( const unsigned char* ) input, charsToWrite );
+
+	// The length is sent as an unsigned short, longer strings keep the old truncating path
+	if ( encodedBitLength <= 0xFFFF )
+	{
+		output->WriteCompressed( ( unsigned short ) encodedBitLength );
+
+		huffmanEncodingTree->EncodeArrayDirect( ( const unsigned char* ) input, charsToWrite, encodedBitLength, output );
+
+		return;
+	}
+
+	BitStream encodedBitStream;
+
+	unsigned short stringBitLength;
+
+	huffmanEncodingTree->EncodeArray( ( const unsigned char* ) input, charsToWrite, &encodedBitStream );
 
 	stringBitLength = ( unsigned short ) encodedBitStream.GetNumberOfBitsUsed();
 
@@ -350,13 +365,18 @@ void StringCompressor::EncodeString( const char *input, int maxCharsToWrite, Bit
 	output->WriteBits( encodedBitStream.GetData(), stringBitLength );
 }
 
-bool StringCompressor::DecodeString( char *output, int maxCharsToWrite, BitStream *input, int languageID )
+bool StringCompressor::DecodeString( char *output, int maxCharsToWrite, BitStream *input, int languageID ) const
 {
 	unsigned short stringBitLength;
 	int bytesInStream;
 
 	output[ 0 ] = 0;
 
+	const HuffmanEncodingTree *huffmanEncodingTree = GetTree( languageID );
+
+	if ( huffmanEncodingTree == 0 )
+		return false;
+
 	if ( input->ReadCompressed( stringBitLength ) == false )
 		return false;
 
@@ -18,63 +18,59 @@
 #ifndef __STRING_COMPRESSOR_H
 #define __STRING_COMPRESSOR_H
 
-/// Forward declaration
+#include <array>
+#include <map>
+#include <memory>
+
 class BitStream;
 
 class HuffmanEncodingTree;
 
-/// \brief Writes and reads strings to and from bitstreams.
-///
-/// Only works with ASCII strings.  The default compression is for English.
-/// You can call GenerateTreeFromStrings to compress and decompress other languages efficiently as well.
+/// The trees are generated by the constructor and never change afterwards, and every call keeps its state on the stack
+/// and in the BitStream it is given, so one instance can be used from any number of threads at once without locks.
 class StringCompressor
 {
 public:
 	
+	/// Generates the English tree as language 0
+	StringCompressor();
+	
+	/// Generates the English tree as language 0 and a tree for each of \a frequencyTables
+	/// \param[in] frequencyTables How often each byte occurs in the strings of a language, by language id.  The sum of a table must fit an unsigned int.  Language 0 stays English.
+	explicit StringCompressor( const std::map<int, std::array<unsigned int, 256>> &frequencyTables );
+	
+	StringCompressor( const StringCompressor & ) = delete;
+	StringCompressor &operator=( const StringCompressor & ) = delete;
+	
 	/// Destructor	
 	~StringCompressor();
 	
-	/// static function because only static functions can access static members
-	/// The RakPeer constructor adds a reference to this class, so don't call this until an instance of RakPeer exists, or unless you call AddReference yourself.
-	/// \return the unique instance of the StringCompressor 
-	static StringCompressor* Instance(void);
-
- 	/// Writes input to output, compressed.  Takes care of the null terminator for you.
+ 	/// Writes input to output, compressed.  Takes care of the null terminator for you.  Nothing is written if \a languageID has no tree.
 	/// \param[in] input Pointer to an ASCII string
 	/// \param[in] maxCharsToWrite The max number of bytes to write of \a input.  Use 0 to mean no limit.
 	/// \param[out] output The bitstream to write the compressed string to
 	/// \param[in] languageID Which language to use
-	void EncodeString( const char *input, int maxCharsToWrite, BitStream *output, int languageID=0 );
+	void EncodeString( const char *input, int maxCharsToWrite, BitStream *output, int languageID=0 ) const;
 	
 	/// Writes input to output, uncompressed.  Takes care of the null terminator for you.
 	/// \param[out] output A block of bytes to receive the output
 	/// \param[in] maxCharsToWrite Size, in bytes, of \a output .  A NULL terminator will always be appended to the output string.  If the maxCharsToWrite is not large enough, the string will be truncated.
 	/// \param[in] input The bitstream containing the compressed string
 	/// \param[in] languageID Which language to use
-	bool DecodeString( char *output, int maxCharsToWrite, BitStream *input, int languageID=0 );
+	/// \return false if \a input is too short or \a languageID has no tree
+	bool DecodeString( char *output, int maxCharsToWrite, BitStream *input, int languageID=0 ) const;
 
-	/// Used so I can allocate and deallocate this singleton at runtime
-	static void AddReference(void);
-	
-	/// Used so I can allocate and deallocate this singleton at runtime
-	static void RemoveReference(void);
+	/// \param[in] languageID Which language to use
+	/// \return true if \a languageID has a tree
+	bool HasTree( int languageID ) const;
 	
 private:
 	
-	/// Private Constructor	
-	StringCompressor();
-	
-	/// Singleton instance
-	static StringCompressor *instance;
+	/// \return The tree of \a languageID, or 0 if it has none
+	const HuffmanEncodingTree *GetTree( int languageID ) const;
 	
-	/// Pointer to the huffman encoding tree.
-	HuffmanEncodingTree *huffmanEncodingTree;
-
-	static int referenceCount;
+	/// The huffman encoding tree of each language.
+	std::map<int, std::unique_ptr<HuffmanEncodingTree>> huffmanEncodingTrees;
 };
 
-/// Define to more easily reference the string compressor instance.
-/// The RakPeer constructor adds a reference to this class, so don't call this until an instance of RakPeer exists, or unless you call AddReference yourself.
-#define stringCompressor StringCompressor::Instance()
-
 #endif
@@ -0,0 +1,233 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "main.h"
+
+void BandwidthMonitor::Window::Add(std::int64_t bucket_id,
+                                   std::uint32_t bytes) {
+  auto &bucket = buckets_[bucket_id % kNumberOfBuckets];
+  if (bucket.id != bucket_id) {
+    bucket.id = bucket_id;
+    bucket.traffic = {};
+  }
+
+  bucket.traffic.bytes += bytes;
+  bucket.traffic.packets++;
+}
+
+BandwidthMonitor::Traffic BandwidthMonitor::Window::Get(
+    std::int64_t bucket_id) const {
+  Traffic traffic;
+
+  for (const auto &bucket : buckets_) {
+    if (bucket.id > bucket_id - static_cast<std::int64_t>(kNumberOfBuckets)) {
+      traffic.bytes += bucket.traffic.bytes;
+      traffic.packets += bucket.traffic.packets;
+    }
+  }
+
+  return traffic;
+}
+
+void BandwidthMonitor::Window::Clear() { buckets_ = {}; }
+
+bool BandwidthMonitor::Admit(int player_id, PR_EventType type,
+                             unsigned char id, BitStream *bs, int priority,
+                             int reliability, char ordering_channel,
+                             bool shift_timestamp) {
+  if (player_id < -1 || player_id >= PR_MAX_PLAYERS) {
+    return true;
+  }
+
+  const auto slot = GetSlot(player_id);
+  const auto bucket_id = GetBucketId();
+
+  // an empty send can't be queued by the scheduler and costs next to
+  // nothing
+  const bool is_empty = !bs || !bs->GetNumberOfBitsUsed();
+
+  if (!is_empty && player_id != -1 && IsLowPriority(priority, reliability) &&
+      IsOverBudget(slot, bucket_id)) {
+    auto &stats = budget_stats_[slot];
+
+    if (budgets_[slot].action != PR_BUDGET_DEFER) {
+      stats.dropped++;
+
+      return false;
+    }
+
+    if (!Plugin::Get().GetSendScheduler().Push(
+            player_id, {type, id, *bs, priority, reliability,
+                        ordering_channel, false, shift_timestamp})) {
+      stats.dropped++;
+
+      return false;
+    }
+
+    stats.deferred++;
+
+    return false;
+  }
+
+  Record(slot, type, id, is_empty ? 0 : bs->GetNumberOfBytesUsed(),
+         bucket_id);
+
+  return true;
+}
+
+bool BandwidthMonitor::IsOverBudget(int player_id, int priority,
+                                    int reliability) {
+  if (player_id < 0 || player_id >= PR_MAX_PLAYERS ||
+      !IsLowPriority(priority, reliability)) {
+    return false;
+  }
+
+  return IsOverBudget(GetSlot(player_id), GetBucketId());
+}
+
+void BandwidthMonitor::Record(int player_id, PR_EventType type,
+                              unsigned char id, std::uint32_t bytes) {
+  if (player_id < -1 || player_id >= PR_MAX_PLAYERS) {
+    return;
+  }
+
+  Record(GetSlot(player_id), type, id, bytes, GetBucketId());
+}
+
+void BandwidthMonitor::ResetPlayer(int player_id) {
+  const auto slot = GetSlot(player_id);
+
+  player_windows_[slot].Clear();
+  player_id_counters_[slot].reset();
+  budget_stats_[slot] = {};
+}
+
+BandwidthMonitor::Traffic BandwidthMonitor::GetPlayerTraffic(int player_id) {
+  return player_windows_[GetSlot(player_id)].Get(GetBucketId());
+}
+
+BandwidthMonitor::Traffic BandwidthMonitor::GetIdTraffic(PR_EventType type,
+                                                         unsigned char id) {
+  return id_windows_[GetTypeIndex(type)][id].Get(GetBucketId());
+}
+
+BandwidthMonitor::Traffic BandwidthMonitor::GetPlayerIdTraffic(
+    int player_id, PR_EventType type, unsigned char id) const {
+  const auto &counters = player_id_counters_[GetSlot(player_id)];
+  if (!counters) {
+    return {};
+  }
+
+  return (*counters)[GetTypeIndex(type)][id];
+}
+
+void BandwidthMonitor::SetBudget(int player_id, std::uint32_t bytes_per_second,
+                                 PR_BudgetAction action) {
+  if (action != PR_BUDGET_DROP && action != PR_BUDGET_DEFER) {
+    throw std::runtime_error{"Invalid budget action"};
+  }
+
+  if (player_id == -1) {
+    for (std::size_t slot{}; slot < PR_MAX_PLAYERS; slot++) {
+      budgets_[slot] = {bytes_per_second, action};
+    }
+
+    return;
+  }
+
+  budgets_[GetSlot(player_id)] = {bytes_per_second, action};
+}
+
+std::pair<std::uint32_t, PR_BudgetAction> BandwidthMonitor::GetBudget(
+    int player_id) const {
+  const auto &budget = budgets_[GetSlot(player_id)];
+
+  return {budget.bytes_per_second, budget.action};
+}
+
+BandwidthMonitor::BudgetStats BandwidthMonitor::GetBudgetStats(
+    int player_id) const {
+  return budget_stats_[GetSlot(player_id)];
+}
+
+std::size_t BandwidthMonitor::GetSlot(int player_id) {
+  if (player_id == -1) {
+    return PR_MAX_PLAYERS;
+  }
+
+  if (player_id < 0 || player_id >= PR_MAX_PLAYERS) {
+    throw std::runtime_error{"Invalid player id " + std::to_string(player_id)};
+  }
+
+  return static_cast<std::size_t>(player_id);
+}
+
+std::size_t BandwidthMonitor::GetTypeIndex(PR_EventType type) {
+  switch (type) {
+    case PR_OUTGOING_PACKET:
+      return 0;
+    case PR_OUTGOING_RPC:
+      return 1;
+    default:
+      throw std::runtime_error{"Only outgoing packets and rpcs are counted"};
+  }
+}
+
+std::int64_t BandwidthMonitor::GetBucketId() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now().time_since_epoch()) /
+         kBucketDuration;
+}
+
+bool BandwidthMonitor::IsLowPriority(int priority, int reliability) {
+  return priority == PR_LOW_PRIORITY || reliability == PR_UNRELIABLE ||
+         reliability == PR_UNRELIABLE_SEQUENCED;
+}
+
+void BandwidthMonitor::Record(std::size_t slot, PR_EventType type,
+                              unsigned char id, std::uint32_t bytes,
+                              std::int64_t bucket_id) {
+  const auto type_index = GetTypeIndex(type);
+
+  player_windows_[slot].Add(bucket_id, bytes);
+  id_windows_[type_index][id].Add(bucket_id, bytes);
+
+  auto &counters = player_id_counters_[slot];
+  if (!counters) {
+    counters = std::make_unique<IdCounters>();
+  }
+
+  auto &traffic = (*counters)[type_index][id];
+
+  traffic.bytes += bytes;
+  traffic.packets++;
+}
+
+bool BandwidthMonitor::IsOverBudget(std::size_t slot,
+                                    std::int64_t bucket_id) const {
+  const auto bytes_per_second = budgets_[slot].bytes_per_second;
+
+  return bytes_per_second &&
+         player_windows_[slot].Get(bucket_id).bytes >= bytes_per_second;
+}
@@ -0,0 +1,124 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PAWNRAKNET_BANDWIDTH_MONITOR_H_
+#define PAWNRAKNET_BANDWIDTH_MONITOR_H_
+
+// Counts outgoing traffic per player and per packet/rpc id over a sliding
+// window of one second and enforces the per-player budgets
+class BandwidthMonitor {
+ public:
+  struct Traffic {
+    std::uint32_t bytes{};
+    std::uint32_t packets{};
+  };
+
+  struct BudgetStats {
+    std::uint32_t dropped{};
+    std::uint32_t deferred{};
+  };
+
+  // Records the send and returns true if it may go out now. Low priority
+  // traffic of a player over budget is dropped or deferred to the send
+  // scheduler instead, shift_timestamp is kept for the deferred rpcs. Never
+  // throws; empty sends always go out
+  bool Admit(int player_id, PR_EventType type, unsigned char id, BitStream *bs,
+             int priority, int reliability, char ordering_channel,
+             bool shift_timestamp = false);
+
+  bool IsOverBudget(int player_id, int priority, int reliability);
+
+  void Record(int player_id, PR_EventType type, unsigned char id,
+              std::uint32_t bytes);
+
+  void ResetPlayer(int player_id);
+
+  Traffic GetPlayerTraffic(int player_id);
+
+  Traffic GetIdTraffic(PR_EventType type, unsigned char id);
+
+  // Not windowed, counted since the last ResetPlayer
+  Traffic GetPlayerIdTraffic(int player_id, PR_EventType type,
+                             unsigned char id) const;
+
+  void SetBudget(int player_id, std::uint32_t bytes_per_second,
+                 PR_BudgetAction action);
+
+  std::pair<std::uint32_t, PR_BudgetAction> GetBudget(int player_id) const;
+
+  BudgetStats GetBudgetStats(int player_id) const;
+
+ private:
+  static constexpr std::size_t kNumberOfBuckets = 10;
+  static constexpr std::chrono::milliseconds kBucketDuration{100};
+
+  // +1 for the broadcasts
+  static constexpr std::size_t kNumberOfSlots = PR_MAX_PLAYERS + 1;
+
+  class Window {
+   public:
+    void Add(std::int64_t bucket_id, std::uint32_t bytes);
+
+    Traffic Get(std::int64_t bucket_id) const;
+
+    void Clear();
+
+   private:
+    struct Bucket {
+      std::int64_t id{-1};
+      Traffic traffic;
+    };
+
+    std::array<Bucket, kNumberOfBuckets> buckets_{};
+  };
+
+  struct Budget {
+    std::uint32_t bytes_per_second{};
+    PR_BudgetAction action{PR_BUDGET_DROP};
+  };
+
+  using IdCounters = std::array<std::array<Traffic, PR_MAX_HANDLERS>, 2>;
+
+  static std::size_t GetSlot(int player_id);
+
+  static std::size_t GetTypeIndex(PR_EventType type);
+
+  static std::int64_t GetBucketId();
+
+  static bool IsLowPriority(int priority, int reliability);
+
+  void Record(std::size_t slot, PR_EventType type, unsigned char id,
+              std::uint32_t bytes, std::int64_t bucket_id);
+
+  bool IsOverBudget(std::size_t slot, std::int64_t bucket_id) const;
+
+  std::array<Window, kNumberOfSlots> player_windows_{};
+  std::array<std::array<Window, PR_MAX_HANDLERS>, 2> id_windows_{};
+  std::array<std::unique_ptr<IdCounters>, kNumberOfSlots> player_id_counters_;
+
+  std::array<Budget, kNumberOfSlots> budgets_{};
+  std::array<BudgetStats, kNumberOfSlots> budget_stats_{};
+};
+
+#endif  // PAWNRAKNET_BANDWIDTH_MONITOR_H_
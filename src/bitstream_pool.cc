@@ -24,27 +24,38 @@
 
 #include "main.h"
 
-BitStream *BitStreamPool::New() {
-  for (auto &[bs, is_occupied] : items_) {
-    if (!is_occupied) {
-      is_occupied = true;
+BitStreamPool::BitStreamPool() : table_{Plugin::Get().GetBitStreamTable()} {}
 
-      return bs.get();
+BitStreamPool::~BitStreamPool() {
+  for (auto &[bs, handle] : items_) {
+    if (handle) {
+      table_->Release(handle);
+    }
+  }
+}
+
+cell BitStreamPool::New() {
+  for (auto &[bs, handle] : items_) {
+    if (!handle) {
+      handle = table_->Register(bs.get());
+
+      return handle;
     }
   }
 
-  const auto &[bs, is_occupied] =
-      items_.emplace_back(std::make_shared<BitStream>(), true);
+  const auto bs = std::make_shared<BitStream>();
 
-  return bs.get();
+  return items_.emplace_back(bs, table_->Register(bs.get())).second;
 }
 
-void BitStreamPool::Delete(BitStream *ptr) {
-  for (auto &[bs, is_occupied] : items_) {
-    if (bs.get() == ptr) {
+void BitStreamPool::Delete(cell handle) {
+  for (auto &[bs, item_handle] : items_) {
+    if (item_handle == handle) {
       bs->Reset();
 
-      is_occupied = false;
+      table_->Release(handle);
+
+      item_handle = 0;
 
       return;
     }
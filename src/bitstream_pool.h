@@ -27,13 +27,20 @@
 
 class BitStreamPool {
  public:
-  BitStream *New();
+  BitStreamPool();
 
-  void Delete(BitStream *ptr);
+  ~BitStreamPool();
+
+  // Returns the handle of a free stream
+  cell New();
+
+  void Delete(cell handle);
 
  private:
   using Item =
-      std::pair<std::shared_ptr<BitStream> /* bs */, bool /* is_occupied */>;
+      std::pair<std::shared_ptr<BitStream> /* bs */, cell /* handle */>;
+
+  std::shared_ptr<BitStreamTable> table_;
 
   std::vector<Item> items_;
 };
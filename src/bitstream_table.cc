@@ -0,0 +1,65 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "main.h"
+
+cell BitStreamTable::Register(BitStream *bs) {
+  std::size_t index{};
+
+  if (!free_slots_.empty()) {
+    index = free_slots_.back();
+
+    free_slots_.pop_back();
+  } else {
+    if (slots_.size() >= kIndexMask) {
+      throw std::runtime_error{"Too many BitStreams"};
+    }
+
+    index = slots_.size();
+
+    slots_.emplace_back();
+  }
+
+  auto &slot = slots_[index];
+
+  slot.bs = bs;
+
+  return static_cast<cell>((slot.generation << kGenerationShift) |
+                           static_cast<std::uint32_t>(index + 1));
+}
+
+void BitStreamTable::Release(cell handle) {
+  if (!Get(handle)) {
+    return;
+  }
+
+  const std::size_t index =
+      (static_cast<std::uint32_t>(handle) & kIndexMask) - 1;
+  auto &slot = slots_[index];
+
+  slot.bs = nullptr;
+  slot.generation = slot.generation == kMaxGeneration ? 1 : slot.generation + 1;
+
+  free_slots_.push_back(index);
+}
@@ -0,0 +1,82 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PAWNRAKNET_BITSTREAM_TABLE_H_
+#define PAWNRAKNET_BITSTREAM_TABLE_H_
+
+// Maps the BitStream handles given to scripts onto the streams. A handle keeps
+// the slot index in its low 16 bits and the slot generation above them, so a
+// handle that outlived its stream is rejected instead of reaching a reused one
+class BitStreamTable {
+ public:
+  // Registers a stream for as long as the scope lives
+  class Scope {
+   public:
+    Scope(BitStreamTable &table, BitStream *bs)
+        : table_{table}, handle_{table.Register(bs)} {}
+
+    ~Scope() { table_.Release(handle_); }
+
+    cell GetHandle() const { return handle_; }
+
+   private:
+    BitStreamTable &table_;
+    cell handle_{};
+  };
+
+  cell Register(BitStream *bs);
+
+  void Release(cell handle);
+
+  // nullptr if the handle has been released or has never been issued
+  BitStream *Get(cell handle) const {
+    const auto value = static_cast<std::uint32_t>(handle);
+    const std::size_t index = (value & kIndexMask) - 1;
+    if (index >= slots_.size()) {
+      return nullptr;
+    }
+
+    const auto &slot = slots_[index];
+    if (slot.generation != value >> kGenerationShift) {
+      return nullptr;
+    }
+
+    return slot.bs;
+  }
+
+ private:
+  static constexpr std::uint32_t kIndexMask = 0xFFFF;
+  static constexpr std::uint32_t kGenerationShift = 16;
+  static constexpr std::uint32_t kMaxGeneration = 0x7FFF;  // keeps cells > 0
+
+  struct Slot {
+    BitStream *bs{};
+    std::uint32_t generation{1};
+  };
+
+  std::vector<Slot> slots_;
+  std::vector<std::size_t> free_slots_;
+};
+
+#endif  // PAWNRAKNET_BITSTREAM_TABLE_H_
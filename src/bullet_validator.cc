@@ -0,0 +1,232 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "main.h"
+
+bool BulletValidator::IsValidAction(PR_BulletAction action) {
+  return action == PR_BULLET_VALIDATION_OFF ||
+         action == PR_BULLET_VALIDATION_FLAG ||
+         action == PR_BULLET_VALIDATION_DROP;
+}
+
+void BulletValidator::SetAction(PR_BulletAction action) {
+  if (!IsValidAction(action)) {
+    throw std::runtime_error{"Invalid bullet validation action"};
+  }
+
+  action_ = action;
+}
+
+PR_BulletAction BulletValidator::GetAction() const { return action_; }
+
+void BulletValidator::SetLagWindow(std::chrono::milliseconds window) {
+  if (window.count() < 0) {
+    throw std::runtime_error{"Invalid lag window"};
+  }
+
+  lag_window_ = window.count() / 1000.0f;
+}
+
+void BulletValidator::SetWeaponRange(int weapon_id, float range) {
+  if (weapon_id < 0 || weapon_id >= static_cast<int>(kNumberOfWeapons)) {
+    throw std::runtime_error{"Invalid weapon id " + std::to_string(weapon_id)};
+  }
+
+  if (!(range >= 0.0f)) {
+    throw std::runtime_error{"Invalid weapon range"};
+  }
+
+  weapon_ranges_[weapon_id] = range;
+}
+
+void BulletValidator::Track(int player_id, const PlayerID &player,
+                            const std::array<float, 3> &position,
+                            const std::array<float, 3> &velocity) {
+  if (!IsValidPlayerId(player_id) || !IsFinite(position) ||
+      !IsFinite(velocity)) {
+    return;
+  }
+
+  Track(player_id, player, position);
+
+  speeds_[player_id] = Distance(velocity, {});
+}
+
+void BulletValidator::Track(int player_id, const PlayerID &player,
+                            const std::array<float, 3> &position) {
+  if (!IsValidPlayerId(player_id) || !IsFinite(position)) {
+    return;
+  }
+
+  Claim(player_id, player);
+
+  positions_[player_id] = position;
+  tracked_at_[player_id] = Tracer::Now();
+}
+
+bool BulletValidator::Check(RakServer &rakserver, const Packet &packet) {
+  const int player_id = packet.playerIndex;
+  if (action_ == PR_BULLET_VALIDATION_OFF || !IsValidPlayerId(player_id) ||
+      !packet.data || !packet.length || packet.data[0] != kBulletSyncId) {
+    return true;
+  }
+
+  Claim(player_id, packet.playerId);
+
+  int violations{};
+
+  if (packet.bitSize < kBulletSyncBits) {
+    violations |= PR_BULLET_MALFORMED;
+  } else {
+    BitStream bs{packet.data, packet.length, false};
+    bs.SetWriteOffset(packet.bitSize);
+    bs.IgnoreBits(8);
+
+    std::uint8_t hit_type{};
+    std::uint16_t hit_id{};
+    Vector3 origin{};
+    Vector3 hit_pos{};
+    Vector3 offsets{};
+    std::uint8_t weapon_id{};
+
+    bs.Read(hit_type);
+    bs.Read(hit_id);
+    for (auto vector : {&origin, &hit_pos, &offsets}) {
+      for (auto &component : *vector) {
+        bs.Read(component);
+      }
+    }
+    bs.Read(weapon_id);
+
+    const auto now = Tracer::Now();
+
+    if (!IsFinite(origin) || !IsFinite(hit_pos) || !IsFinite(offsets)) {
+      violations |= PR_BULLET_NON_FINITE;
+    } else {
+      const float range =
+          weapon_id < kNumberOfWeapons ? weapon_ranges_[weapon_id] : 0.0f;
+      if (range <= 0.0f) {
+        violations |= PR_BULLET_WEAPON;
+      } else if (Distance(origin, hit_pos) > range) {
+        violations |= PR_BULLET_RANGE;
+      }
+
+      if (!tracked_at_[player_id] ||
+          Distance(origin, positions_[player_id]) >
+              GetReach(player_id, now, kOriginTolerance)) {
+        violations |= PR_BULLET_ORIGIN;
+      }
+
+      if (hit_type == kHitTypePlayer) {
+        const int target_id = hit_id;
+
+        // the target has to be someone else who is known to be near the hit
+        if (target_id == player_id || !IsValidPlayerId(target_id) ||
+            !tracked_at_[target_id]) {
+          violations |= PR_BULLET_TARGET;
+        } else {
+          const auto target = rakserver.GetPlayerIDFromIndex(target_id);
+
+          if (owners_[target_id].binaryAddress != target.binaryAddress ||
+              owners_[target_id].port != target.port ||
+              Distance(hit_pos, positions_[target_id]) >
+                  GetReach(target_id, now, kTargetTolerance)) {
+            violations |= PR_BULLET_TARGET;
+          }
+        }
+      }
+    }
+  }
+
+  last_violations_[player_id] = violations;
+
+  if (!violations) {
+    return true;
+  }
+
+  if (action_ == PR_BULLET_VALIDATION_DROP) {
+    stats_[player_id].dropped++;
+
+    return false;
+  }
+
+  stats_[player_id].flagged++;
+
+  return true;
+}
+
+int BulletValidator::GetLastViolation(int player_id) const {
+  if (!IsValidPlayerId(player_id)) {
+    throw std::runtime_error{"Invalid player id " + std::to_string(player_id)};
+  }
+
+  return last_violations_[player_id];
+}
+
+BulletValidator::Stats BulletValidator::GetStats(int player_id) const {
+  if (!IsValidPlayerId(player_id)) {
+    throw std::runtime_error{"Invalid player id " + std::to_string(player_id)};
+  }
+
+  return stats_[player_id];
+}
+
+float BulletValidator::Distance(const Vector3 &a, const Vector3 &b) {
+  const float dx = a[0] - b[0];
+  const float dy = a[1] - b[1];
+  const float dz = a[2] - b[2];
+
+  return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+bool BulletValidator::IsFinite(const Vector3 &v) {
+  return std::isfinite(v[0]) && std::isfinite(v[1]) && std::isfinite(v[2]);
+}
+
+bool BulletValidator::IsValidPlayerId(int player_id) {
+  return player_id >= 0 && player_id < PR_MAX_PLAYERS;
+}
+
+float BulletValidator::GetReach(int player_id, std::int64_t now,
+                                float tolerance) const {
+  const float age =
+      std::max(now - tracked_at_[player_id], std::int64_t{}) / 1e6f;
+
+  // the sync velocity is in units per 1/50 of a second
+  return tolerance + speeds_[player_id] * 50.0f * (age + lag_window_);
+}
+
+void BulletValidator::Claim(int player_id, const PlayerID &player) {
+  auto &owner = owners_[player_id];
+  if (owner.binaryAddress == player.binaryAddress &&
+      owner.port == player.port) {
+    return;
+  }
+
+  owner = player;
+  speeds_[player_id] = 0.0f;
+  tracked_at_[player_id] = 0;
+  last_violations_[player_id] = 0;
+  stats_[player_id] = {};
+}
@@ -0,0 +1,120 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PAWNRAKNET_BULLET_VALIDATOR_H_
+#define PAWNRAKNET_BULLET_VALIDATOR_H_
+
+// Plausibility checks of the incoming bullet sync against the last known
+// positions of the shooter and the target and the range of the weapon.
+// Runs in the Receive hook, which is installed while the validation is on,
+// before the incoming packet handlers (the raw packet handlers run earlier)
+class BulletValidator {
+ public:
+  struct Stats {
+    std::uint32_t flagged{};
+    std::uint32_t dropped{};
+  };
+
+  static bool IsValidAction(PR_BulletAction action);
+
+  void SetAction(PR_BulletAction action);
+
+  PR_BulletAction GetAction() const;
+
+  // Positions older than the window are still used, with a tolerance grown
+  // by the distance the player could have moved in the meantime
+  void SetLagWindow(std::chrono::milliseconds window);
+
+  // 0 means the weapon doesn't fire bullets
+  void SetWeaponRange(int weapon_id, float range);
+
+  void Track(int player_id, const PlayerID &player,
+             const std::array<float, 3> &position,
+             const std::array<float, 3> &velocity);
+
+  // For the passenger sync, which has no velocity. The speed of the last
+  // sync with one is kept
+  void Track(int player_id, const PlayerID &player,
+             const std::array<float, 3> &position);
+
+  // False if the packet is a bullet sync that has to be dropped, the
+  // violations (PR_BulletViolation) are kept for PR_GetBulletViolation
+  bool Check(RakServer &rakserver, const Packet &packet);
+
+  int GetLastViolation(int player_id) const;
+
+  Stats GetStats(int player_id) const;
+
+ private:
+  static constexpr unsigned char kBulletSyncId = 206;
+  static constexpr unsigned int kBulletSyncBits = 328;
+
+  static constexpr unsigned char kHitTypePlayer = 1;
+
+  // weapon ids of SA-MP go up to 46
+  static constexpr std::size_t kNumberOfWeapons = 47;
+
+  // player center to gun muzzle/hit point plus sync jitter, in meters
+  static constexpr float kOriginTolerance = 5.0f;
+  static constexpr float kTargetTolerance = 3.0f;
+
+  using Vector3 = std::array<float, 3>;
+
+  template <typename T>
+  using PerPlayer = std::array<T, PR_MAX_PLAYERS>;
+
+  static float Distance(const Vector3 &a, const Vector3 &b);
+
+  static bool IsFinite(const Vector3 &v);
+
+  static bool IsValidPlayerId(int player_id);
+
+  // The radius around the last known position of the player that the
+  // player may be in by now
+  float GetReach(int player_id, std::int64_t now, float tolerance) const;
+
+  // Forgets what is known about the previous player with the id
+  void Claim(int player_id, const PlayerID &player);
+
+  PR_BulletAction action_{PR_BULLET_VALIDATION_OFF};
+  float lag_window_{0.25f};  // seconds
+
+  // ranges of weapon-config, the ones SA-MP clients actually reach
+  std::array<float, kNumberOfWeapons> weapon_ranges_{
+      0.0f,  0.0f,  0.0f,   0.0f,   0.0f,  0.0f,  0.0f,  0.0f,  0.0f,  0.0f,
+      0.0f,  0.0f,  0.0f,   0.0f,   0.0f,  0.0f,  0.0f,  0.0f,  0.0f,  0.0f,
+      0.0f,  0.0f,  35.0f,  35.0f,  35.0f, 40.0f, 35.0f, 40.0f, 35.0f, 45.0f,
+      70.0f, 90.0f, 35.0f,  100.0f, 320.0f, 0.0f, 0.0f,  0.0f,  75.0f, 0.0f,
+      0.0f,  0.0f,  0.0f,   0.0f,   0.0f,  0.0f,  0.0f};
+
+  PerPlayer<Vector3> positions_{};
+  PerPlayer<float> speeds_{};
+  PerPlayer<std::int64_t> tracked_at_{};  // steady clock, microseconds
+  PerPlayer<PlayerID> owners_{};
+
+  PerPlayer<int> last_violations_{};
+  PerPlayer<Stats> stats_{};
+};
+
+#endif  // PAWNRAKNET_BULLET_VALIDATOR_H_
@@ -26,11 +26,15 @@
 
 Config::Config(const std::string &file_path) : file_path_{file_path} {}
 
-void Config::Read() {
+void Config::Read() { Read(Parse()); }
+
+std::shared_ptr<cpptoml::table> Config::Parse() const {
   std::fstream{file_path_, std::fstream::out | std::fstream::app};
 
-  const auto config = cpptoml::parse_file(file_path_);
+  return cpptoml::parse_file(file_path_);
+}
 
+void Config::Read(const std::shared_ptr<cpptoml::table> &config) {
   // backward compatibility
   bool intercept_outcoming_packet =
       config->get_as<bool>("InterceptOutcomingPacket").value_or(true);
@@ -52,6 +56,9 @@ void Config::Read() {
   intercept_outgoing_internal_packet_ =
       config->get_as<bool>("InterceptOutgoingInternalPacket").value_or(false);
 
+  std::array<bool, PR_MAX_HANDLERS> whitelist_internal_packets{};
+  bool whitelist_is_empty{true};
+
   auto packet_ids = config->get_array_of<int64_t>("WhiteListInternalPackets")
                         .value_or(std::vector<int64_t>{});
   for (auto &packet_id : packet_ids) {
@@ -60,15 +67,46 @@ void Config::Read() {
       continue;
     }
 
-    whitelist_internal_packets_[static_cast<unsigned char>(packet_id)] = true;
+    whitelist_internal_packets[static_cast<unsigned char>(packet_id)] = true;
 
-    whitelist_is_empty_ = false;
+    whitelist_is_empty = false;
   }
 
+  // on reload the ids that are no longer listed have to be dropped as well
+  for (std::size_t packet_id{}; packet_id < whitelist_internal_packets.size();
+       packet_id++) {
+    whitelist_internal_packets_[packet_id] =
+        whitelist_internal_packets[packet_id];
+  }
+  whitelist_is_empty_ = whitelist_is_empty;
+
   use_caching_ = config->get_as<bool>("UseCaching").value_or(false);
   log_amx_errors_ = config->get_as<bool>("LogAmxErrors").value_or(true);
+  watch_config_file_ =
+      config->get_as<bool>("WatchConfigFile").value_or(false);
+  packet_tap_name_ =
+      config->get_as<std::string>("PacketTapName").value_or("");
+  packet_tap_size_ = static_cast<std::uint32_t>(
+      config->get_as<int64_t>("PacketTapSize").value_or(4 * 1024 * 1024));
+  injection_channel_name_ =
+      config->get_as<std::string>("InjectionChannelName").value_or("");
+  injection_channel_slots_ = static_cast<std::uint32_t>(
+      config->get_as<int64_t>("InjectionChannelSlots").value_or(1024));
+  injection_channel_tick_limit_ = static_cast<std::uint32_t>(
+      config->get_as<int64_t>("InjectionChannelTickLimit").value_or(256));
+  enable_tracing_ = config->get_as<bool>("EnableTracing").value_or(false);
+  trace_file_ = config->get_as<std::string>("TraceFile")
+                    .value_or("pawnraknet_trace.json");
+  string_cache_size_ = static_cast<std::uint32_t>(
+      config->get_as<int64_t>("StringCacheSize").value_or(1024));
+  language_tables_ = config->get_array_of<std::string>("LanguageTables")
+                         .value_or(std::vector<std::string>{});
+
+  last_write_time_ = GetLastWriteTime();
 }
 
+void Config::Skip() { last_write_time_ = GetLastWriteTime(); }
+
 void Config::Save() {
   auto config = cpptoml::make_table();
 
@@ -78,9 +116,9 @@ void Config::Save() {
   config->insert("InterceptOutgoingRPC", intercept_outgoing_rpc_);
   config->insert("InterceptIncomingRawPacket", intercept_incoming_raw_packet_);
   config->insert("InterceptIncomingInternalPacket",
-                 intercept_incoming_internal_packet_);
+                 intercept_incoming_internal_packet_.load());
   config->insert("InterceptOutgoingInternalPacket",
-                 intercept_outgoing_internal_packet_);
+                 intercept_outgoing_internal_packet_.load());
 
   auto packet_ids = cpptoml::make_array();
   if (!whitelist_is_empty_) {
@@ -95,6 +133,23 @@ void Config::Save() {
 
   config->insert("UseCaching", use_caching_);
   config->insert("LogAmxErrors", log_amx_errors_);
+  config->insert("WatchConfigFile", watch_config_file_);
+  config->insert("PacketTapName", packet_tap_name_);
+  config->insert("PacketTapSize", static_cast<int64_t>(packet_tap_size_));
+  config->insert("InjectionChannelName", injection_channel_name_);
+  config->insert("InjectionChannelSlots",
+                 static_cast<int64_t>(injection_channel_slots_));
+  config->insert("InjectionChannelTickLimit",
+                 static_cast<int64_t>(injection_channel_tick_limit_));
+  config->insert("EnableTracing", enable_tracing_);
+  config->insert("TraceFile", trace_file_);
+  config->insert("StringCacheSize", static_cast<int64_t>(string_cache_size_));
+
+  auto language_tables = cpptoml::make_array();
+  for (const auto &file : language_tables_) {
+    language_tables->push_back(file);
+  }
+  config->insert("LanguageTables", language_tables);
 
   std::fstream{file_path_, std::fstream::out | std::fstream::trunc}
       << (*config);
@@ -131,3 +186,44 @@ bool Config::IsWhiteListedInternalPacket(unsigned char packet_id) const {
 bool Config::UseCaching() const { return use_caching_; }
 
 bool Config::LogAmxErrors() const { return log_amx_errors_; }
+
+bool Config::WatchConfigFile() const { return watch_config_file_; }
+
+const std::string &Config::PacketTapName() const { return packet_tap_name_; }
+
+std::uint32_t Config::PacketTapSize() const { return packet_tap_size_; }
+
+const std::string &Config::InjectionChannelName() const {
+  return injection_channel_name_;
+}
+
+std::uint32_t Config::InjectionChannelSlots() const {
+  return injection_channel_slots_;
+}
+
+std::uint32_t Config::InjectionChannelTickLimit() const {
+  return injection_channel_tick_limit_;
+}
+
+bool Config::EnableTracing() const { return enable_tracing_; }
+
+const std::string &Config::TraceFile() const { return trace_file_; }
+
+std::uint32_t Config::StringCacheSize() const { return string_cache_size_; }
+
+const std::vector<std::string> &Config::LanguageTables() const {
+  return language_tables_;
+}
+
+bool Config::IsModified() const {
+  return GetLastWriteTime() != last_write_time_;
+}
+
+std::time_t Config::GetLastWriteTime() const {
+  struct stat file_stat {};
+  if (stat(file_path_.c_str(), &file_stat) != 0) {
+    return {};
+  }
+
+  return file_stat.st_mtime;
+}
@@ -33,6 +33,14 @@ class Config {
 
   void Read();
 
+  // Throws if the file isn't valid TOML
+  std::shared_ptr<cpptoml::table> Parse() const;
+
+  void Read(const std::shared_ptr<cpptoml::table> &config);
+
+  // Keeps the current settings and waits for the next write of the file
+  void Skip();
+
   void Save();
 
   bool InterceptIncomingPacket() const;
@@ -55,7 +63,35 @@ class Config {
 
   bool LogAmxErrors() const;
 
+  bool WatchConfigFile() const;
+
+  // empty if the packet tap is disabled
+  const std::string &PacketTapName() const;
+
+  std::uint32_t PacketTapSize() const;
+
+  // empty if the injection channel is disabled
+  const std::string &InjectionChannelName() const;
+
+  std::uint32_t InjectionChannelSlots() const;
+
+  std::uint32_t InjectionChannelTickLimit() const;
+
+  bool EnableTracing() const;
+
+  const std::string &TraceFile() const;
+
+  std::uint32_t StringCacheSize() const;
+
+  // frequency tables of the languages 1, 2, ... of PR_CSTRING
+  const std::vector<std::string> &LanguageTables() const;
+
+  // true if the file has been written since the last Read
+  bool IsModified() const;
+
  private:
+  std::time_t GetLastWriteTime() const;
+
   std::string file_path_;
 
   bool intercept_incoming_packet_{};
@@ -63,14 +99,27 @@ class Config {
   bool intercept_outgoing_packet_{};
   bool intercept_outgoing_rpc_{};
   bool intercept_incoming_raw_packet_{};
-  bool intercept_incoming_internal_packet_{};
-  bool intercept_outgoing_internal_packet_{};
 
-  std::array<bool, PR_MAX_HANDLERS> whitelist_internal_packets_{};
-  bool whitelist_is_empty_{true};
+  // read from the RakNet thread, so they may change under it on reload
+  std::atomic_bool intercept_incoming_internal_packet_{};
+  std::atomic_bool intercept_outgoing_internal_packet_{};
+  std::array<std::atomic_bool, PR_MAX_HANDLERS> whitelist_internal_packets_{};
+  std::atomic_bool whitelist_is_empty_{true};
 
   bool use_caching_{};
   bool log_amx_errors_{};
+  bool watch_config_file_{};
+  std::string packet_tap_name_;
+  std::uint32_t packet_tap_size_{};
+  std::string injection_channel_name_;
+  std::uint32_t injection_channel_slots_{};
+  std::uint32_t injection_channel_tick_limit_{};
+  bool enable_tracing_{};
+  std::string trace_file_;
+  std::uint32_t string_cache_size_{};
+  std::vector<std::string> language_tables_;
+
+  std::time_t last_write_time_{};
 };
 
 #endif  // PAWNRAKNET_CONFIG_H_
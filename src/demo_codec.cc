@@ -0,0 +1,236 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "main.h"
+
+void DemoCodec::Reset() { has_previous_.fill(false); }
+
+void DemoCodec::Encode(int player_id, std::uint16_t time, Frame &frame,
+                       std::vector<std::uint8_t> &out) {
+  Quantize(frame);
+
+  const auto &previous = previous_[player_id];
+
+  std::uint8_t flags{};
+
+  std::array<std::int16_t, 3> delta{};
+
+  if (!has_previous_[player_id] || previous.in_car != frame.in_car) {
+    flags = kDemoFrameKeyframe | kDemoFrameAll;
+  } else {
+    for (std::size_t i{}; i < delta.size(); i++) {
+      const auto centimeters =
+          std::lround((frame.position[i] - previous.position[i]) * 100.0f);
+      if (centimeters < INT16_MIN || centimeters > INT16_MAX) {
+        flags = kDemoFrameKeyframe | kDemoFrameAll;
+
+        break;
+      }
+
+      delta[i] = static_cast<std::int16_t>(centimeters);
+    }
+  }
+
+  if (!(flags & kDemoFrameKeyframe)) {
+    for (std::size_t i{}; i < delta.size(); i++) {
+      frame.position[i] = previous.position[i] + delta[i] / 100.0f;
+    }
+
+    if (frame.lr_key != previous.lr_key || frame.ud_key != previous.ud_key ||
+        frame.keys != previous.keys) {
+      flags |= kDemoFrameKeys;
+    }
+
+    if (frame.quaternion != previous.quaternion) {
+      flags |= kDemoFrameRotation;
+    }
+
+    if (frame.velocity != previous.velocity) {
+      flags |= kDemoFrameVelocity;
+    }
+
+    if (frame.vehicle_id != previous.vehicle_id ||
+        frame.vehicle_health != previous.vehicle_health ||
+        frame.health != previous.health || frame.armour != previous.armour ||
+        frame.weapon_id != previous.weapon_id ||
+        frame.special_action != previous.special_action ||
+        frame.animation_id != previous.animation_id ||
+        frame.animation_flags != previous.animation_flags) {
+      flags |= kDemoFrameState;
+    }
+  }
+
+  if (frame.in_car) {
+    flags |= kDemoFrameInCar;
+  }
+
+  Put(out, static_cast<std::uint16_t>(player_id));
+  Put(out, time);
+  Put(out, flags);
+
+  if (flags & kDemoFrameKeys) {
+    Put(out, frame.lr_key);
+    Put(out, frame.ud_key);
+    Put(out, frame.keys);
+  }
+
+  for (std::size_t i{}; i < delta.size(); i++) {
+    if (flags & kDemoFrameKeyframe) {
+      Put(out, frame.position[i]);
+    } else {
+      Put(out, delta[i]);
+    }
+  }
+
+  if (flags & kDemoFrameRotation) {
+    for (const auto component : frame.quaternion) {
+      Put(out, Quantize(component, kDemoQuaternionScale));
+    }
+  }
+
+  if (flags & kDemoFrameVelocity) {
+    for (const auto component : frame.velocity) {
+      Put(out, Quantize(component, kDemoVelocityScale));
+    }
+  }
+
+  if (flags & kDemoFrameState) {
+    Put(out, frame.vehicle_id);
+    Put(out, frame.vehicle_health);
+    Put(out, frame.health);
+    Put(out, frame.armour);
+    Put(out, frame.weapon_id);
+    Put(out, frame.special_action);
+    Put(out, frame.animation_id);
+    Put(out, frame.animation_flags);
+  }
+
+  previous_[player_id] = frame;
+  has_previous_[player_id] = true;
+}
+
+bool DemoCodec::Decode(const std::vector<std::uint8_t> &data,
+                       std::size_t &offset, int &player_id,
+                       std::uint16_t &time, Frame &frame) {
+  std::uint16_t id{};
+  std::uint8_t flags{};
+
+  if (!Get(data, offset, id) || !Get(data, offset, time) ||
+      !Get(data, offset, flags) || id >= PR_MAX_PLAYERS) {
+    return false;
+  }
+
+  const bool keyframe = flags & kDemoFrameKeyframe;
+  if (!keyframe && !has_previous_[id]) {
+    return false;
+  }
+
+  if (keyframe) {
+    frame = {};
+  } else {
+    frame = previous_[id];
+  }
+
+  frame.in_car = flags & kDemoFrameInCar;
+
+  if (flags & kDemoFrameKeys) {
+    if (!Get(data, offset, frame.lr_key) || !Get(data, offset, frame.ud_key) ||
+        !Get(data, offset, frame.keys)) {
+      return false;
+    }
+  }
+
+  for (auto &component : frame.position) {
+    if (keyframe) {
+      if (!Get(data, offset, component)) {
+        return false;
+      }
+    } else {
+      std::int16_t delta{};
+      if (!Get(data, offset, delta)) {
+        return false;
+      }
+
+      component += delta / 100.0f;
+    }
+  }
+
+  if (flags & kDemoFrameRotation) {
+    for (auto &component : frame.quaternion) {
+      std::int16_t value{};
+      if (!Get(data, offset, value)) {
+        return false;
+      }
+
+      component = value / kDemoQuaternionScale;
+    }
+  }
+
+  if (flags & kDemoFrameVelocity) {
+    for (auto &component : frame.velocity) {
+      std::int16_t value{};
+      if (!Get(data, offset, value)) {
+        return false;
+      }
+
+      component = value / kDemoVelocityScale;
+    }
+  }
+
+  if (flags & kDemoFrameState) {
+    if (!Get(data, offset, frame.vehicle_id) ||
+        !Get(data, offset, frame.vehicle_health) ||
+        !Get(data, offset, frame.health) || !Get(data, offset, frame.armour) ||
+        !Get(data, offset, frame.weapon_id) ||
+        !Get(data, offset, frame.special_action) ||
+        !Get(data, offset, frame.animation_id) ||
+        !Get(data, offset, frame.animation_flags)) {
+      return false;
+    }
+  }
+
+  player_id = id;
+  previous_[id] = frame;
+  has_previous_[id] = true;
+
+  return true;
+}
+
+std::int16_t DemoCodec::Quantize(float value, float scale) {
+  const auto limit = static_cast<float>(INT16_MAX);
+
+  return static_cast<std::int16_t>(
+      std::lround(std::max(-limit, std::min(value * scale, limit))));
+}
+
+void DemoCodec::Quantize(Frame &frame) {
+  for (auto &component : frame.quaternion) {
+    component =
+        Quantize(component, kDemoQuaternionScale) / kDemoQuaternionScale;
+  }
+
+  for (auto &component : frame.velocity) {
+    component = Quantize(component, kDemoVelocityScale) / kDemoVelocityScale;
+  }
+}
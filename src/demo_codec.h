@@ -0,0 +1,96 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PAWNRAKNET_DEMO_CODEC_H_
+#define PAWNRAKNET_DEMO_CODEC_H_
+
+// Encodes and decodes the frames of demo chunks (see demo_layout.h). The
+// recorder and the player each keep one, reset at every chunk, and both
+// rebuild the previous frame of a player from the quantized values, so the
+// deltas don't drift
+class DemoCodec {
+ public:
+  struct Frame {
+    bool in_car{};
+    std::uint16_t vehicle_id{};
+    std::uint16_t lr_key{};
+    std::uint16_t ud_key{};
+    std::uint16_t keys{};
+    std::array<float, 3> position{};
+    std::array<float, 4> quaternion{};
+    std::array<float, 3> velocity{};
+    std::uint16_t vehicle_health{};
+    std::uint8_t health{};
+    std::uint8_t armour{};
+    std::uint8_t weapon_id{};
+    std::uint8_t special_action{};
+    std::int16_t animation_id{};
+    std::int16_t animation_flags{};
+  };
+
+  void Reset();
+
+  // Appends the frame to out, frame is replaced by what the decoder will get
+  void Encode(int player_id, std::uint16_t time, Frame &frame,
+              std::vector<std::uint8_t> &out);
+
+  // Decodes the frame at data[offset], moves offset past it. False if the
+  // chunk is malformed
+  bool Decode(const std::vector<std::uint8_t> &data, std::size_t &offset,
+              int &player_id, std::uint16_t &time, Frame &frame);
+
+ private:
+  template <typename T>
+  static void Put(std::vector<std::uint8_t> &out, T value) {
+    const auto size = out.size();
+
+    out.resize(size + sizeof(T));
+
+    std::memcpy(&out[size], &value, sizeof(T));
+  }
+
+  template <typename T>
+  static bool Get(const std::vector<std::uint8_t> &data, std::size_t &offset,
+                  T &value) {
+    if (data.size() - offset < sizeof(T)) {
+      return false;
+    }
+
+    std::memcpy(&value, &data[offset], sizeof(T));
+
+    offset += sizeof(T);
+
+    return true;
+  }
+
+  static std::int16_t Quantize(float value, float scale);
+
+  // Rounds the rotation and the velocity to what the file can hold
+  static void Quantize(Frame &frame);
+
+  std::array<Frame, PR_MAX_PLAYERS> previous_{};
+  std::array<bool, PR_MAX_PLAYERS> has_previous_{};
+};
+
+#endif  // PAWNRAKNET_DEMO_CODEC_H_
@@ -0,0 +1,99 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PAWNRAKNET_DEMO_LAYOUT_H_
+#define PAWNRAKNET_DEMO_LAYOUT_H_
+
+// Layout of the demo (movement recording) files. Everything is little-endian
+// and 8-byte aligned, so the file can be mapped and read in place.
+//
+// The file is a DemoHeader, the chunks and the index. A chunk is a
+// DemoChunkHeader followed by `size` bytes of frames, padded to 8 bytes, and
+// covers at most kDemoChunkDuration ms. The index, at `index_offset`, is
+// `number_of_chunks` DemoIndexEntry sorted by start_ms, so a reader seeks by
+// a binary search over it. index_offset is 0 until the recording is stopped.
+//
+// A frame is
+//   uint16 player id, uint16 ms since the start of the chunk, uint8 flags,
+//   if kDemoFrameKeys: uint16 lr key, uint16 ud key, uint16 keys,
+//   position: float[3] in a keyframe, else int16[3] in centimeters from the
+//     position of the previous frame of the player,
+//   if kDemoFrameRotation: int16[4] quaternion * kDemoQuaternionScale,
+//   if kDemoFrameVelocity: int16[3] velocity * kDemoVelocityScale,
+//   if kDemoFrameState: uint16 vehicle id, uint16 vehicle health, uint8
+//     health, uint8 armour, uint8 weapon id, uint8 special action, int16
+//     animation id, int16 animation flags.
+// The first frame of every player in a chunk is a keyframe, which has all of
+// the flags, so decoding can start at any chunk. Fields that are not in a
+// frame are the same as in the previous one.
+
+#include <cstdint>
+
+constexpr std::uint32_t kDemoMagic = 0x4D445250;  // "PRDM"
+constexpr std::uint32_t kDemoVersion = 1;
+constexpr std::uint32_t kDemoChunkDuration = 1000;  // ms
+
+constexpr float kDemoQuaternionScale = 32767.0f;
+constexpr float kDemoVelocityScale = 1024.0f;
+
+enum DemoFrameFlags : std::uint8_t {
+  kDemoFrameKeyframe = 1 << 0,
+  kDemoFrameInCar = 1 << 1,
+  kDemoFrameKeys = 1 << 2,
+  kDemoFrameRotation = 1 << 3,
+  kDemoFrameVelocity = 1 << 4,
+  kDemoFrameState = 1 << 5,
+
+  kDemoFrameAll =
+      kDemoFrameKeys | kDemoFrameRotation | kDemoFrameVelocity | kDemoFrameState
+};
+
+struct DemoHeader {
+  std::uint32_t magic;
+  std::uint32_t version;
+  std::uint32_t header_size;
+  std::uint32_t chunk_duration;  // ms
+  std::uint64_t index_offset;
+  std::uint32_t number_of_chunks;
+  std::uint32_t duration;  // ms
+};
+
+struct DemoChunkHeader {
+  std::uint32_t start_ms;  // since the start of the recording
+  std::uint32_t size;      // of the frames, without the padding
+  std::uint32_t number_of_frames;
+  std::uint32_t reserved;
+};
+
+struct DemoIndexEntry {
+  std::uint32_t start_ms;
+  std::uint32_t reserved;
+  std::uint64_t offset;  // of the DemoChunkHeader
+};
+
+static_assert(sizeof(DemoHeader) == 32, "DemoHeader layout");
+static_assert(sizeof(DemoChunkHeader) == 16, "DemoChunkHeader layout");
+static_assert(sizeof(DemoIndexEntry) == 16, "DemoIndexEntry layout");
+
+#endif  // PAWNRAKNET_DEMO_LAYOUT_H_
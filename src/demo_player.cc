@@ -0,0 +1,182 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "main.h"
+
+int DemoPlayer::Start(const std::string &file_path,
+                      std::vector<int> spectators, std::uint32_t start_ms) {
+  for (const auto spectator : spectators) {
+    if (spectator < 0 || spectator >= PR_MAX_PLAYERS) {
+      throw std::runtime_error{"Invalid player id " +
+                               std::to_string(spectator)};
+    }
+  }
+
+  auto playback = std::make_unique<Playback>();
+
+  playback->reader.Open(file_path);
+
+  playback->spectators = std::move(spectators);
+
+  Seek(*playback, start_ms);
+
+  const int playback_id = next_playback_id_++;
+
+  playbacks_.emplace(playback_id, std::move(playback));
+
+  return playback_id;
+}
+
+bool DemoPlayer::Stop(int playback_id) {
+  return playbacks_.erase(playback_id) != 0;
+}
+
+bool DemoPlayer::Seek(int playback_id, std::uint32_t ms) {
+  const auto iter = playbacks_.find(playback_id);
+  if (iter == playbacks_.end()) {
+    return false;
+  }
+
+  Seek(*iter->second, ms);
+
+  return true;
+}
+
+void DemoPlayer::Process(RakServer &rakserver, BandwidthMonitor &monitor) {
+  const auto now = std::chrono::steady_clock::now();
+
+  for (auto iter = playbacks_.begin(); iter != playbacks_.end();) {
+    auto &playback = *iter->second;
+
+    const auto time =
+        playback.base_ms +
+        static_cast<std::uint32_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                now - playback.started_at)
+                .count());
+
+    auto &reader = playback.reader;
+
+    for (; reader.HasFrame() && reader.GetTime() <= time; reader.Next()) {
+      const int player_id = reader.GetPlayerId();
+
+      BitStream bs;
+
+      WriteFrame(bs, player_id, reader.GetFrame());
+
+      const auto packet_id = *bs.GetData();
+
+      for (const auto spectator : playback.spectators) {
+        if (spectator == player_id) {
+          continue;
+        }
+
+        if (monitor.Admit(spectator, PR_OUTGOING_PACKET, packet_id, &bs,
+                          PR_HIGH_PRIORITY, PR_UNRELIABLE_SEQUENCED, 0)) {
+          rakserver.Send(&bs, PR_HIGH_PRIORITY, PR_UNRELIABLE_SEQUENCED, 0,
+                         rakserver.GetPlayerIDFromIndex(spectator), false);
+        }
+      }
+    }
+
+    if (!reader.HasFrame()) {
+      iter = playbacks_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+}
+
+void DemoPlayer::Seek(Playback &playback, std::uint32_t ms) {
+  playback.reader.Seek(ms);
+
+  playback.base_ms = ms;
+  playback.started_at = std::chrono::steady_clock::now();
+}
+
+void DemoPlayer::WriteFrame(BitStream &bs, int player_id,
+                            const DemoCodec::Frame &frame) {
+  const auto &q = frame.quaternion;
+  const auto &v = frame.velocity;
+
+  if (frame.in_car) {
+    bs.Write(kVehicleSyncId);
+    bs.Write(static_cast<std::uint16_t>(player_id));
+    bs.Write(frame.vehicle_id);
+    bs.Write(frame.lr_key);
+    bs.Write(frame.ud_key);
+    bs.Write(frame.keys);
+    bs.WriteNormQuat(q[0], q[1], q[2], q[3]);
+    for (const auto component : frame.position) {
+      bs.Write(component);
+    }
+    bs.WriteVector(v[0], v[1], v[2]);
+    bs.Write(frame.vehicle_health);
+    bs.Write(PackHealthArmour(frame.health, frame.armour));
+    bs.Write(frame.weapon_id);
+    bs.Write(false);  // siren
+    bs.Write(false);  // landing gear
+    bs.Write(false);  // train speed
+    bs.Write(false);  // trailer
+
+    return;
+  }
+
+  bs.Write(kPlayerSyncId);
+  bs.Write(static_cast<std::uint16_t>(player_id));
+
+  for (const auto key : {frame.lr_key, frame.ud_key}) {
+    bs.Write(key != 0);
+    if (key) {
+      bs.Write(key);
+    }
+  }
+
+  bs.Write(frame.keys);
+  for (const auto component : frame.position) {
+    bs.Write(component);
+  }
+  bs.WriteNormQuat(q[0], q[1], q[2], q[3]);
+  bs.Write(PackHealthArmour(frame.health, frame.armour));
+  bs.Write(frame.weapon_id);
+  bs.Write(frame.special_action);
+  bs.WriteVector(v[0], v[1], v[2]);
+  bs.Write(false);  // surfing
+
+  const bool has_animation = frame.animation_id || frame.animation_flags;
+
+  bs.Write(has_animation);
+  if (has_animation) {
+    bs.Write(frame.animation_id);
+    bs.Write(frame.animation_flags);
+  }
+}
+
+std::uint8_t DemoPlayer::PackHealthArmour(int health, int armour) {
+  const auto pack = [](int value) {
+    return value >= 100 ? 0xF : std::max(value, 0) / 7;
+  };
+
+  return static_cast<std::uint8_t>(pack(health) << 4 | pack(armour));
+}
@@ -0,0 +1,66 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PAWNRAKNET_DEMO_PLAYER_H_
+#define PAWNRAKNET_DEMO_PLAYER_H_
+
+// Plays demo files back to spectators as outgoing on-foot and in-car sync of
+// the recorded player ids, from OnProcessTick
+class DemoPlayer {
+ public:
+  // Returns the playback id
+  int Start(const std::string &file_path, std::vector<int> spectators,
+            std::uint32_t start_ms);
+
+  bool Stop(int playback_id);
+
+  bool Seek(int playback_id, std::uint32_t ms);
+
+  void Process(RakServer &rakserver, BandwidthMonitor &monitor);
+
+ private:
+  static constexpr unsigned char kVehicleSyncId = 200;
+  static constexpr unsigned char kPlayerSyncId = 207;
+
+  struct Playback {
+    DemoReader reader;
+    std::vector<int> spectators;
+
+    std::uint32_t base_ms{};
+    std::chrono::steady_clock::time_point started_at;
+  };
+
+  static void Seek(Playback &playback, std::uint32_t ms);
+
+  static void WriteFrame(BitStream &bs, int player_id,
+                         const DemoCodec::Frame &frame);
+
+  // health and armour in steps of 7, 0xF for 100 and over
+  static std::uint8_t PackHealthArmour(int health, int armour);
+
+  std::unordered_map<int, std::unique_ptr<Playback>> playbacks_;
+  int next_playback_id_{1};
+};
+
+#endif  // PAWNRAKNET_DEMO_PLAYER_H_
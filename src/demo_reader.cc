@@ -0,0 +1,132 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "main.h"
+
+void DemoReader::Open(const std::string &file_path) {
+  file_.open(file_path, std::ifstream::binary);
+  if (!file_) {
+    throw std::runtime_error{"Can't open " + file_path};
+  }
+
+  if (!file_.read(reinterpret_cast<char *>(&header_), sizeof(header_)) ||
+      header_.magic != kDemoMagic || header_.version != kDemoVersion) {
+    throw std::runtime_error{file_path + " is not a demo"};
+  }
+
+  if (!header_.index_offset) {
+    throw std::runtime_error{"Recording of " + file_path + " isn't finished"};
+  }
+
+  index_.resize(header_.number_of_chunks);
+
+  file_.seekg(header_.index_offset);
+
+  if (!file_.read(reinterpret_cast<char *>(index_.data()),
+                  index_.size() * sizeof(DemoIndexEntry))) {
+    throw std::runtime_error{"Index of " + file_path + " is truncated"};
+  }
+
+  Seek(0);
+}
+
+void DemoReader::Seek(std::uint32_t ms) {
+  // the last chunk that starts at or before ms
+  const auto next = std::upper_bound(
+      index_.begin(), index_.end(), ms,
+      [](std::uint32_t value, const DemoIndexEntry &entry) {
+        return value < entry.start_ms;
+      });
+
+  const std::size_t chunk_index =
+      next == index_.begin() ? 0 : std::distance(index_.begin(), next) - 1;
+
+  if (!LoadChunk(chunk_index)) {
+    chunk_index_ = index_.size();
+    chunk_.clear();
+    offset_ = 0;
+  }
+
+  // the frames before ms only bring the decoder up to date
+  has_frame_ = Decode();
+  while (has_frame_ && time_ < ms) {
+    has_frame_ = Decode();
+  }
+}
+
+bool DemoReader::HasFrame() const { return has_frame_; }
+
+void DemoReader::Next() { has_frame_ = Decode(); }
+
+int DemoReader::GetPlayerId() const { return player_id_; }
+
+std::uint32_t DemoReader::GetTime() const { return time_; }
+
+const DemoCodec::Frame &DemoReader::GetFrame() const { return frame_; }
+
+bool DemoReader::Decode() {
+  while (offset_ >= chunk_.size()) {
+    if (!LoadChunk(chunk_index_ + 1)) {
+      return false;
+    }
+  }
+
+  std::uint16_t time{};
+
+  if (!codec_.Decode(chunk_, offset_, player_id_, time, frame_)) {
+    return false;
+  }
+
+  time_ = chunk_header_.start_ms + time;
+
+  return true;
+}
+
+bool DemoReader::LoadChunk(std::size_t chunk_index) {
+  if (chunk_index >= index_.size()) {
+    return false;
+  }
+
+  file_.clear();
+  file_.seekg(index_[chunk_index].offset);
+
+  if (!file_.read(reinterpret_cast<char *>(&chunk_header_),
+                  sizeof(chunk_header_)) ||
+      chunk_header_.size > header_.index_offset) {
+    return false;
+  }
+
+  chunk_.resize(chunk_header_.size);
+
+  if (!file_.read(reinterpret_cast<char *>(chunk_.data()),
+                  chunk_header_.size)) {
+    return false;
+  }
+
+  chunk_index_ = chunk_index;
+  offset_ = 0;
+  codec_.Reset();
+
+  return true;
+}
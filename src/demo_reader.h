@@ -0,0 +1,69 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PAWNRAKNET_DEMO_READER_H_
+#define PAWNRAKNET_DEMO_READER_H_
+
+// Reads the frames of a finished demo file (see demo_layout.h) in order,
+// seeking through the time index
+class DemoReader {
+ public:
+  void Open(const std::string &file_path);
+
+  // Moves to the first frame at or after ms
+  void Seek(std::uint32_t ms);
+
+  // False at the end of the demo
+  bool HasFrame() const;
+
+  void Next();
+
+  int GetPlayerId() const;
+
+  std::uint32_t GetTime() const;  // ms since the start of the recording
+
+  const DemoCodec::Frame &GetFrame() const;
+
+ private:
+  bool Decode();
+
+  bool LoadChunk(std::size_t chunk_index);
+
+  std::ifstream file_;
+  DemoHeader header_{};
+  std::vector<DemoIndexEntry> index_;
+
+  std::size_t chunk_index_{};
+  DemoChunkHeader chunk_header_{};
+  std::vector<std::uint8_t> chunk_;
+  std::size_t offset_{};
+  DemoCodec codec_;
+
+  bool has_frame_{};
+  int player_id_{};
+  std::uint32_t time_{};
+  DemoCodec::Frame frame_;
+};
+
+#endif  // PAWNRAKNET_DEMO_READER_H_
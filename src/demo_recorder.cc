@@ -0,0 +1,208 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "main.h"
+
+DemoRecorder::~DemoRecorder() { Stop(); }
+
+void DemoRecorder::Start(const std::string &file_path) {
+  if (IsRecording()) {
+    throw std::runtime_error{"Demo recording is already running"};
+  }
+
+  file_.open(file_path, std::ofstream::binary | std::ofstream::trunc);
+  if (!file_) {
+    throw std::runtime_error{"Can't open " + file_path};
+  }
+
+  // rewritten with the index offset in Stop
+  Write(DemoHeader{kDemoMagic, kDemoVersion, sizeof(DemoHeader),
+                   kDemoChunkDuration});
+
+  started_at_ = std::chrono::steady_clock::now();
+  chunk_.clear();
+  chunk_header_ = {};
+  index_.clear();
+}
+
+bool DemoRecorder::Stop() {
+  if (!IsRecording()) {
+    return false;
+  }
+
+  FlushChunk();
+
+  const auto index_offset = static_cast<std::uint64_t>(file_.tellp());
+
+  for (const auto &entry : index_) {
+    Write(entry);
+  }
+
+  file_.seekp(0);
+
+  Write(DemoHeader{kDemoMagic, kDemoVersion, sizeof(DemoHeader),
+                   kDemoChunkDuration, index_offset,
+                   static_cast<std::uint32_t>(index_.size()), GetTime()});
+
+  file_.close();
+
+  index_.clear();
+  index_.shrink_to_fit();
+
+  return true;
+}
+
+bool DemoRecorder::IsRecording() const { return file_.is_open(); }
+
+void DemoRecorder::Record(const SyncStore &sync_store,
+                          SyncStore::SyncType type, int player_id) {
+  if (!IsRecording() || player_id < 0 || player_id >= PR_MAX_PLAYERS) {
+    return;
+  }
+
+  DemoCodec::Frame frame{};
+
+  if (type == SyncStore::kOnFoot) {
+    const auto &s = sync_store.GetOnFoot();
+
+    frame.lr_key = s.lr_key[player_id];
+    frame.ud_key = s.ud_key[player_id];
+    frame.keys = s.keys[player_id];
+    frame.position = s.position[player_id];
+    frame.quaternion = s.quaternion[player_id];
+    frame.velocity = s.velocity[player_id];
+    frame.health = s.health[player_id];
+    frame.armour = s.armour[player_id];
+    frame.weapon_id = s.weapon_id[player_id];
+    frame.special_action = s.special_action[player_id];
+    frame.animation_id = s.animation_id[player_id];
+    frame.animation_flags = s.animation_flags[player_id];
+  } else if (type == SyncStore::kInCar) {
+    const auto &s = sync_store.GetInCar();
+
+    const float vehicle_health = s.vehicle_health[player_id];
+
+    frame.in_car = true;
+    frame.vehicle_id = s.vehicle_id[player_id];
+    frame.lr_key = s.lr_key[player_id];
+    frame.ud_key = s.ud_key[player_id];
+    frame.keys = s.keys[player_id];
+    frame.position = s.position[player_id];
+    frame.quaternion = s.quaternion[player_id];
+    frame.velocity = s.velocity[player_id];
+    frame.vehicle_health = static_cast<std::uint16_t>(
+        std::isfinite(vehicle_health)
+            ? std::max(0.0f, std::min(vehicle_health, 65535.0f))
+            : 0.0f);
+    frame.health = s.player_health[player_id];
+    frame.armour = s.armour[player_id];
+    frame.weapon_id = s.weapon_id[player_id];
+  } else {
+    return;
+  }
+
+  if (!IsFinite(frame)) {
+    return;
+  }
+
+  const auto now = GetTime();
+
+  if (chunk_header_.number_of_frames &&
+      (now - chunk_header_.start_ms >= kDemoChunkDuration ||
+       chunk_.size() >= kMaxChunkSize)) {
+    FlushChunk();
+  }
+
+  if (!chunk_header_.number_of_frames) {
+    chunk_header_.start_ms = now;
+
+    codec_.Reset();
+  }
+
+  codec_.Encode(player_id,
+                static_cast<std::uint16_t>(now - chunk_header_.start_ms),
+                frame, chunk_);
+
+  chunk_header_.number_of_frames++;
+}
+
+bool DemoRecorder::IsFinite(const DemoCodec::Frame &frame) {
+  for (const auto component : frame.position) {
+    if (!std::isfinite(component)) {
+      return false;
+    }
+  }
+
+  for (const auto component : frame.quaternion) {
+    if (!std::isfinite(component)) {
+      return false;
+    }
+  }
+
+  for (const auto component : frame.velocity) {
+    if (!std::isfinite(component)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+std::uint32_t DemoRecorder::GetTime() const {
+  return static_cast<std::uint32_t>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now() - started_at_)
+          .count());
+}
+
+void DemoRecorder::WritePadding() {
+  const auto size = static_cast<std::size_t>(file_.tellp()) % 8;
+  if (!size) {
+    return;
+  }
+
+  const std::array<char, 8> padding{};
+
+  file_.write(padding.data(), 8 - size);
+}
+
+void DemoRecorder::FlushChunk() {
+  if (!chunk_header_.number_of_frames) {
+    return;
+  }
+
+  index_.push_back(
+      {chunk_header_.start_ms, 0, static_cast<std::uint64_t>(file_.tellp())});
+
+  chunk_header_.size = static_cast<std::uint32_t>(chunk_.size());
+
+  Write(chunk_header_);
+
+  file_.write(reinterpret_cast<const char *>(chunk_.data()), chunk_.size());
+
+  WritePadding();
+
+  chunk_.clear();
+  chunk_header_ = {};
+}
@@ -0,0 +1,71 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PAWNRAKNET_DEMO_RECORDER_H_
+#define PAWNRAKNET_DEMO_RECORDER_H_
+
+// Writes the on-foot and in-car sync of all players to a demo file (see
+// demo_layout.h), one chunk at a time
+class DemoRecorder {
+ public:
+  ~DemoRecorder();
+
+  void Start(const std::string &file_path);
+
+  // Writes the index and closes the file, false if nothing was being
+  // recorded
+  bool Stop();
+
+  bool IsRecording() const;
+
+  void Record(const SyncStore &sync_store, SyncStore::SyncType type,
+              int player_id);
+
+ private:
+  static constexpr std::size_t kMaxChunkSize = 256 * 1024;
+
+  static bool IsFinite(const DemoCodec::Frame &frame);
+
+  std::uint32_t GetTime() const;
+
+  template <typename T>
+  void Write(const T &value) {
+    file_.write(reinterpret_cast<const char *>(&value), sizeof(T));
+  }
+
+  void WritePadding();
+
+  void FlushChunk();
+
+  std::ofstream file_;
+  std::chrono::steady_clock::time_point started_at_;
+
+  DemoCodec codec_;
+  std::vector<std::uint8_t> chunk_;
+  DemoChunkHeader chunk_header_{};
+
+  std::vector<DemoIndexEntry> index_;
+};
+
+#endif  // PAWNRAKNET_DEMO_RECORDER_H_
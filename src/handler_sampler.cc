@@ -0,0 +1,75 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "main.h"
+
+HandlerSampler::HandlerSampler(unsigned int interval,
+                               unsigned int min_interval_ms)
+    : interval_{interval},
+      min_interval_{std::chrono::milliseconds{min_interval_ms}} {}
+
+bool HandlerSampler::Pass(RakServer &rakserver, int player_id) {
+  if (player_id < 0 || player_id >= PR_MAX_PLAYERS) {
+    return true;
+  }
+
+  Claim(player_id, rakserver.GetPlayerIDFromIndex(player_id));
+
+  if (interval_ > 1) {
+    auto &counter = counters_[player_id];
+
+    const bool pass = counter == 0;
+
+    counter = (counter + 1) % interval_;
+
+    if (!pass) {
+      return false;
+    }
+  }
+
+  if (min_interval_.count()) {
+    const auto now = Clock::now();
+
+    auto &last_call = last_calls_[player_id];
+    if (now - last_call < min_interval_) {
+      return false;
+    }
+
+    last_call = now;
+  }
+
+  return true;
+}
+
+void HandlerSampler::Claim(int player_id, const PlayerID &player) {
+  auto &owner = owners_[player_id];
+  if (owner.binaryAddress == player.binaryAddress &&
+      owner.port == player.port) {
+    return;
+  }
+
+  owner = player;
+  counters_[player_id] = 0;
+  last_calls_[player_id] = {};
+}
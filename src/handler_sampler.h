@@ -0,0 +1,50 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PAWNRAKNET_HANDLER_SAMPLER_H_
+#define PAWNRAKNET_HANDLER_SAMPLER_H_
+
+// Lets a handler see only every Nth event and/or no more than one event per
+// min_interval_ms for each player
+class HandlerSampler {
+ public:
+  HandlerSampler(unsigned int interval, unsigned int min_interval_ms);
+
+  bool Pass(RakServer &rakserver, int player_id);
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  // Forgets the counter and the last call of the previous player with the id
+  void Claim(int player_id, const PlayerID &player);
+
+  unsigned int interval_{};
+  Clock::duration min_interval_{};
+
+  std::array<unsigned int, PR_MAX_PLAYERS> counters_{};
+  std::array<Clock::time_point, PR_MAX_PLAYERS> last_calls_{};
+  std::array<PlayerID, PR_MAX_PLAYERS> owners_{};
+};
+
+#endif  // PAWNRAKNET_HANDLER_SAMPLER_H_
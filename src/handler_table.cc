@@ -0,0 +1,64 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "main.h"
+
+void HandlerTable::Add(PR_EventType type, unsigned char event_id,
+                       const Handler &handler) {
+  if (type < 0 || type >= PR_NUMBER_OF_EVENT_TYPES) {
+    throw std::runtime_error{"Invalid event type"};
+  }
+
+  const auto key = GetKey(type, event_id);
+
+  if (dispatch_depth_) {
+    pending_.emplace_back(key, handler);
+
+    return;
+  }
+
+  Insert(key, handler);
+}
+
+void HandlerTable::Insert(std::size_t key, const Handler &handler) {
+  if (handlers_.size() >= (std::numeric_limits<std::uint16_t>::max)()) {
+    throw std::runtime_error{"Too many handlers"};
+  }
+
+  handlers_.insert(handlers_.begin() + offsets_[key + 1], handler);
+
+  for (auto index = key + 1; index < offsets_.size(); index++) {
+    offsets_[index]++;
+  }
+}
+
+void HandlerTable::InsertPending() {
+  auto pending = std::move(pending_);
+
+  pending_.clear();
+
+  for (const auto &[key, handler] : pending) {
+    Insert(key, handler);
+  }
+}
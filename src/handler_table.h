@@ -0,0 +1,110 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PAWNRAKNET_HANDLER_TABLE_H_
+#define PAWNRAKNET_HANDLER_TABLE_H_
+
+using PublicPtr = std::shared_ptr<ptl::Public>;
+
+struct Handler {
+  PublicPtr pub;
+  bool read_only{};
+  std::shared_ptr<HandlerSampler> sampler;
+  const char *trace_name{};
+};
+
+// Handlers of all events packed into one vector, ordered by (type, event id).
+// An event's handlers are handlers_[offsets_[key]] .. handlers_[offsets_[key +
+// 1]], so a script with a few handlers doesn't pay for 2048 empty lists
+class HandlerTable {
+ public:
+  struct Range {
+    const Handler *first{};
+    const Handler *last{};
+
+    const Handler *begin() const { return first; }
+
+    const Handler *end() const { return last; }
+  };
+
+  // Keeps the handlers from being moved while they are being executed.
+  // Handlers added meanwhile are inserted once the last scope is left
+  class DispatchScope {
+   public:
+    explicit DispatchScope(HandlerTable &table) : table_{table} {
+      table_.dispatch_depth_++;
+    }
+
+    ~DispatchScope() {
+      if (--table_.dispatch_depth_ == 0 && !table_.pending_.empty()) {
+        table_.InsertPending();
+      }
+    }
+
+   private:
+    HandlerTable &table_;
+  };
+
+  void Add(PR_EventType type, unsigned char event_id, const Handler &handler);
+
+  Range Get(PR_EventType type, unsigned char event_id) const {
+    const auto key = GetKey(type, event_id);
+    const auto data = handlers_.data();
+
+    return {data + offsets_[key], data + offsets_[key + 1]};
+  }
+
+  template <typename F>
+  void ForEach(F func) const {
+    std::size_t key{};
+
+    for (std::size_t index{}; index < handlers_.size(); index++) {
+      while (offsets_[key + 1] <= index) {
+        key++;
+      }
+
+      func(static_cast<PR_EventType>(key / PR_MAX_HANDLERS),
+           static_cast<unsigned char>(key % PR_MAX_HANDLERS),
+           handlers_[index]);
+    }
+  }
+
+ private:
+  static std::size_t GetKey(PR_EventType type, unsigned char event_id) {
+    return static_cast<std::size_t>(type) * PR_MAX_HANDLERS + event_id;
+  }
+
+  void Insert(std::size_t key, const Handler &handler);
+
+  void InsertPending();
+
+  std::array<std::uint16_t, PR_NUMBER_OF_EVENT_TYPES * PR_MAX_HANDLERS + 1>
+      offsets_{};
+  std::vector<Handler> handlers_;
+
+  std::size_t dispatch_depth_{};
+  std::vector<std::pair<std::size_t /* key */, Handler>> pending_;
+};
+
+#endif  // PAWNRAKNET_HANDLER_TABLE_H_
@@ -24,6 +24,8 @@
 
 #include "main.h"
 
+bool Hooks::emulated_packet_turn_{};
+
 PluginReceiveResult MessageHandler::OnReceive(RakPeerInterface *peer,
                                               Packet *packet) {
   const auto player_id = packet->playerIndex;
@@ -34,14 +36,20 @@ PluginReceiveResult MessageHandler::OnReceive(RakPeerInterface *peer,
 
   auto &plugin = Plugin::Get();
 
+  if (!plugin.GetConfig()->InterceptIncomingRawPacket()) {
+    return PluginReceiveResult::RR_CONTINUE_PROCESSING;
+  }
+
   BitStream bs{packet->data, packet->length, false};
 
-  if (!Plugin::OnEvent<PR_INCOMING_RAW_PACKET>(
-          player_id, plugin.GetPacketId(packet), &bs)) {
+  const auto packet_id = plugin.GetPacketId(packet);
+
+  if (!Plugin::OnEvent<PR_INCOMING_RAW_PACKET>(player_id, packet_id, &bs)) {
     return PluginReceiveResult::RR_STOP_PROCESSING_AND_DEALLOCATE;
   }
 
-  if (packet->data != bs.GetData()) {
+  if (plugin.MayModifyStream(PR_INCOMING_RAW_PACKET, packet_id) &&
+      !Hooks::CommitInPlace(packet, bs)) {
     if (packet->deleteData) {
       delete packet->data;
     }
@@ -98,14 +106,29 @@ bool THISCALL Hooks::RakServer__Send(void *_this, BitStream *bs, int priority,
     return false;
   }
 
-  auto &rakserver = Plugin::Get().GetRakServer();
+  auto &plugin = Plugin::Get();
+  auto &rakserver = plugin.GetRakServer();
+
+  const int player_id =
+      broadcast ? -1 : rakserver->GetIndexFromPlayerID(playerId);
 
-  if (!Plugin::OnEvent<PR_OUTGOING_PACKET>(
-          broadcast ? -1 : rakserver->GetIndexFromPlayerID(playerId),
-          *bs->GetData(), bs)) {
+  const Tracer::Span span{plugin.GetTracer(), "RakServer::Send",
+                          *bs->GetData(), player_id};
+
+  if (plugin.GetConfig()->InterceptOutgoingPacket() &&
+      !Plugin::OnEvent<PR_OUTGOING_PACKET>(player_id, *bs->GetData(), bs)) {
     return false;
   }
 
+  if (!plugin.GetBandwidthMonitor().Admit(player_id, PR_OUTGOING_PACKET,
+                                          *bs->GetData(), bs, priority,
+                                          reliability, orderingChannel)) {
+    return false;
+  }
+
+  plugin.GetPacketTap().Write(PR_OUTGOING_PACKET, *bs->GetData(), player_id,
+                              *bs);
+
   return rakserver->Send(bs, priority, reliability, orderingChannel, playerId,
                          broadcast);
 }
@@ -126,38 +149,124 @@ bool THISCALL Hooks::RakServer__RPC(void *_this, RPCIndex *uniqueID,
     bs = &empty_bs;
   }
 
-  auto &rakserver = Plugin::Get().GetRakServer();
+  auto &plugin = Plugin::Get();
+  auto &rakserver = plugin.GetRakServer();
+
+  const int player_id =
+      broadcast ? -1 : rakserver->GetIndexFromPlayerID(playerId);
+
+  const Tracer::Span span{plugin.GetTracer(), "RakServer::RPC", rpc_id,
+                          player_id};
+
+  if (plugin.GetConfig()->InterceptOutgoingRPC() &&
+      !Plugin::OnEvent<PR_OUTGOING_RPC>(player_id, rpc_id, bs)) {
+    return false;
+  }
 
-  if (!Plugin::OnEvent<PR_OUTGOING_RPC>(
-          broadcast ? -1 : rakserver->GetIndexFromPlayerID(playerId), rpc_id,
-          bs)) {
+  if (!plugin.GetBandwidthMonitor().Admit(player_id, PR_OUTGOING_RPC, rpc_id,
+                                          bs, priority, reliability,
+                                          orderingChannel, shiftTimestamp)) {
     return false;
   }
 
+  plugin.GetPacketTap().Write(PR_OUTGOING_RPC, rpc_id, player_id, *bs);
+
   return rakserver->RPC(uniqueID, bs, priority, reliability, orderingChannel,
                         playerId, broadcast, shiftTimestamp);
 }
 
 Packet *THISCALL Hooks::RakServer__Receive(void *_this) {
   auto &plugin = Plugin::Get();
-  auto &rakserver = plugin.GetRakServer();
 
-  auto packet = plugin.GetNextPacketToEmulate();
+  const Tracer::Span span{plugin.GetTracer(), "RakServer::Receive"};
+
+  const auto packet = SelectPacket();
   if (packet) {
+    auto &sync_store = plugin.GetSyncStore();
+
+    const auto type = sync_store.Update(*packet);
+    if (type == SyncStore::kOnFoot || type == SyncStore::kInCar) {
+      const int player_id = packet->playerIndex;
+
+      const auto &position = sync_store.GetPosition(type, player_id);
+      const auto &velocity = sync_store.GetVelocity(type, player_id);
+
+      plugin.GetMovementValidator().Record(player_id, packet->playerId,
+                                           position, velocity);
+      plugin.GetBulletValidator().Track(player_id, packet->playerId, position,
+                                        velocity);
+      plugin.GetDemoRecorder().Record(sync_store, type, player_id);
+    } else if (type == SyncStore::kPassenger) {
+      const int player_id = packet->playerIndex;
+
+      plugin.GetBulletValidator().Track(
+          player_id, packet->playerId,
+          sync_store.GetPosition(type, player_id));
+    }
+  }
+
+  return packet;
+}
+
+Packet *Hooks::SelectPacket() {
+  auto &plugin = Plugin::Get();
+
+  if ((plugin.UsePacketBatch() &&
+       plugin.GetConfig()->InterceptIncomingPacket()) ||
+      plugin.GetPacketBatch().HasPendingPackets()) {
+    return ReceivePacketBatch();
+  }
+
+  // emulated and real packets take turns, so a flood of emulated ones
+  // doesn't hold the real ones back
+  emulated_packet_turn_ = !emulated_packet_turn_;
+
+  Packet *packet{};
+
+  if (emulated_packet_turn_ && (packet = plugin.GetNextPacketToEmulate())) {
+    return packet;
+  }
+
+  if (packet = ReceivePacket()) {
     return packet;
   }
 
+  return plugin.GetNextPacketToEmulate();
+}
+
+Packet *Hooks::ReceivePacket() {
+  auto &plugin = Plugin::Get();
+  auto &rakserver = plugin.GetRakServer();
+
+  Packet *packet{};
+
   while (packet = rakserver->Receive()) {
     const auto player_id = packet->playerIndex;
     if (player_id == static_cast<PlayerIndex>(-1)) {
       break;
     }
 
+    plugin.GetPacketTap().Write(PR_INCOMING_PACKET, plugin.GetPacketId(packet),
+                                player_id, packet->data,
+                                packet->bitSize);
+
+    if (!plugin.GetBulletValidator().Check(*rakserver, *packet)) {
+      rakserver->DeallocatePacket(packet);
+
+      continue;
+    }
+
+    if (!plugin.GetConfig()->InterceptIncomingPacket()) {
+      break;
+    }
+
     BitStream bs{packet->data, packet->length, false};
 
-    if (Plugin::OnEvent<PR_INCOMING_PACKET>(player_id,
-                                            plugin.GetPacketId(packet), &bs)) {
-      if (packet->data != bs.GetData()) {
+    const auto packet_id = plugin.GetPacketId(packet);
+
+    if (Plugin::OnEvent<PR_INCOMING_PACKET>(player_id, packet_id, &bs)) {
+      if (plugin.MayModifyStream(PR_INCOMING_PACKET, packet_id) &&
+          !CommitInPlace(packet, bs)) {
         rakserver->DeallocatePacket(packet);
 
         packet = plugin.NewPacket(player_id, bs);
@@ -172,6 +281,77 @@ Packet *THISCALL Hooks::RakServer__Receive(void *_this) {
   return packet;
 }
 
+Packet *Hooks::ReceivePacketBatch() {
+  auto &plugin = Plugin::Get();
+  auto &rakserver = plugin.GetRakServer();
+  auto &batch = plugin.GetPacketBatch();
+
+  if (batch.HasPendingPackets()) {
+    return batch.PopPacket();
+  }
+
+  batch.Clear();
+
+  for (bool received = true; received;) {
+    received = false;
+
+    // emulated packets are handed out as they are, like the non-player ones
+    if (const auto packet = plugin.GetNextPacketToEmulate()) {
+      batch.Add(packet);
+
+      received = true;
+    }
+
+    if (const auto packet = rakserver->Receive()) {
+      auto &entry = batch.Add(packet);
+
+      entry.is_player_packet =
+          packet->playerIndex != static_cast<PlayerIndex>(-1);
+      if (entry.is_player_packet) {
+        entry.packet_id = plugin.GetPacketId(packet);
+
+        plugin.GetPacketTap().Write(PR_INCOMING_PACKET, entry.packet_id,
+                                    packet->playerIndex, packet->data,
+                                    packet->bitSize);
+
+        entry.accepted =
+            plugin.GetBulletValidator().Check(*rakserver, *packet);
+      }
+
+      received = true;
+    }
+  }
+
+  if (batch.GetEntries().empty()) {
+    return nullptr;
+  }
+
+  Plugin::OnPacketBatch(batch);
+
+  for (auto &entry : batch.GetEntries()) {
+    if (!entry.is_player_packet) {
+      continue;
+    }
+
+    if (!entry.accepted) {
+      rakserver->DeallocatePacket(entry.packet);
+
+      continue;
+    }
+
+    if (plugin.MayModifyStream(PR_INCOMING_PACKET, entry.packet_id) &&
+        !CommitInPlace(entry.packet, entry.bs)) {
+      const auto player_id = entry.packet->playerIndex;
+
+      rakserver->DeallocatePacket(entry.packet);
+
+      entry.packet = plugin.NewPacket(player_id, entry.bs);
+    }
+  }
+
+  return batch.PopPacket();
+}
+
 void *THISCALL Hooks::RakServer__RegisterAsRemoteProcedureCall(
     void *_this, RPCIndex *uniqueID, RPCFunction functionPointer) {
   if (!uniqueID || !functionPointer) {
@@ -180,23 +360,36 @@ void *THISCALL Hooks::RakServer__RegisterAsRemoteProcedureCall(
 
   auto &plugin = Plugin::Get();
   auto &rakserver = plugin.GetRakServer();
-  auto &config = plugin.GetConfig();
 
   const auto rpc_id = *uniqueID;
 
   plugin.SetOriginalRPCHandler(rpc_id, functionPointer);
 
-  if (config->InterceptIncomingRPC()) {
-    functionPointer = plugin.GetFakeRPCHandler(rpc_id);
-  }
-
-  return rakserver->RegisterAsRemoteProcedureCall(uniqueID, functionPointer);
+  return rakserver->RegisterAsRemoteProcedureCall(
+      uniqueID, plugin.GetFakeRPCHandler(rpc_id));
 }
 
 void Hooks::HandleRPC(RPCIndex rpc_id, RPCParameters *p) {
   auto &plugin = Plugin::Get();
   auto &rakserver = plugin.GetRakServer();
 
+  const auto original_handler = plugin.GetOriginalRPCHandler(rpc_id);
+
+  const Tracer::Span span{plugin.GetTracer(), "HandleRPC", rpc_id};
+
+  auto &tap = plugin.GetPacketTap();
+  if (tap.IsOpen()) {
+    tap.Write(original_handler ? PR_INCOMING_RPC : PR_INCOMING_CUSTOM_RPC,
+              rpc_id, rakserver->GetIndexFromPlayerID(p->sender), p->input,
+              p->numberOfBitsOfData);
+  }
+
+  if (original_handler && !plugin.GetConfig()->InterceptIncomingRPC()) {
+    original_handler(p);
+
+    return;
+  }
+
   const int player_id = rakserver->GetIndexFromPlayerID(p->sender);
   if (player_id == -1) {
     return;
@@ -209,8 +402,6 @@ void Hooks::HandleRPC(RPCIndex rpc_id, RPCParameters *p) {
     bs.SetWriteOffset(p->numberOfBitsOfData);
   }
 
-  const auto original_handler = plugin.GetOriginalRPCHandler(rpc_id);
-
   const auto on_event = original_handler
                             ? Plugin::OnEvent<PR_INCOMING_RPC>
                             : Plugin::OnEvent<PR_INCOMING_CUSTOM_RPC>;
@@ -220,7 +411,9 @@ void Hooks::HandleRPC(RPCIndex rpc_id, RPCParameters *p) {
 
   if (original_handler) {
     const auto numberOfBitsUsed = bs.GetNumberOfBitsUsed();
-    if (p->numberOfBitsOfData != numberOfBitsUsed) {
+    if (plugin.MayModifyStream(PR_INCOMING_RPC, rpc_id) &&
+        (p->numberOfBitsOfData != numberOfBitsUsed ||
+         p->input != bs.GetData())) {
       p->input = numberOfBitsUsed > 0 ? bs.GetData() : nullptr;
       p->numberOfBitsOfData = numberOfBitsUsed;
     }
@@ -229,6 +422,22 @@ void Hooks::HandleRPC(RPCIndex rpc_id, RPCParameters *p) {
   }
 }
 
+bool Hooks::CommitInPlace(Packet *packet, const BitStream &bs) {
+  if (packet->data != bs.GetData()) {
+    return false;
+  }
+
+  const auto number_of_bits_used = bs.GetNumberOfBitsUsed();
+  if (number_of_bits_used > 0 &&
+      static_cast<unsigned int>(number_of_bits_used) !=
+          BYTES_TO_BITS(packet->length)) {
+    packet->length = BITS_TO_BYTES(number_of_bits_used);
+    packet->bitSize = number_of_bits_used;
+  }
+
+  return true;
+}
+
 urmem::address_t Hooks::GetRakServerInterface() {
   auto &plugin = Plugin::Get();
 
@@ -72,9 +72,26 @@ class Hooks {
 
   static void HandleRPC(RPCIndex rpc_id, RPCParameters *p);
 
+  // Picks the next packet from the batch, the emulation ring or RakServer
+  static Packet *SelectPacket();
+
+  // Returns the next packet accepted by the scripts
+  static Packet *ReceivePacket();
+
+  // Drains everything RakServer::Receive has for this tick, dispatches it to
+  // the scripts at once and then hands the accepted packets out one by one
+  static Packet *ReceivePacketBatch();
+
+  // Applies changes made by handlers to the packet's own buffer. Returns false
+  // if the stream has been reallocated and the packet has to be rebuilt
+  static bool CommitInPlace(Packet *packet, const BitStream &bs);
+
   static urmem::address_t GetRakServerInterface();
 
   static int AMXAPI amx_Cleanup(AMX *amx);
+
+ private:
+  static bool emulated_packet_turn_;
 };
 
 template <>
@@ -0,0 +1,214 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "main.h"
+
+InjectionChannel::~InjectionChannel() { Close(); }
+
+void InjectionChannel::Open(const std::string &name,
+                            std::uint32_t slot_count) {
+  Close();
+
+  if (slot_count < 16 || slot_count > 65536) {
+    throw std::runtime_error{"Invalid injection channel slot count " +
+                             std::to_string(slot_count)};
+  }
+
+  std::uint32_t rounded_slot_count{16};
+  while (rounded_slot_count < slot_count) {
+    rounded_slot_count <<= 1;
+  }
+
+  const std::size_t header_size = sizeof(InjectionChannelHeader);
+  memory_.Create(name, header_size + std::size_t{rounded_slot_count} *
+                                         kSlotSize);
+
+  const auto mapping = memory_.GetData();
+
+  slots_ = static_cast<unsigned char *>(mapping) + header_size;
+
+  for (std::uint32_t i{}; i < rounded_slot_count; i++) {
+    auto slot = new (slots_ + std::size_t{i} * kSlotSize) InjectionSlot{};
+
+    slot->sequence.store(i, std::memory_order_relaxed);
+  }
+
+  // producers check the magic, so it is written last
+  header_ = new (mapping) InjectionChannelHeader{};
+  header_->version = kInjectionChannelVersion;
+  header_->slot_count = rounded_slot_count;
+  header_->slot_size = kSlotSize;
+  header_->header_size = static_cast<std::uint32_t>(header_size);
+  std::atomic_thread_fence(std::memory_order_release);
+  header_->magic = kInjectionChannelMagic;
+}
+
+void InjectionChannel::Close() {
+  if (!header_) {
+    return;
+  }
+
+  header_->magic = 0;
+
+  memory_.Close();
+
+  header_ = nullptr;
+  slots_ = nullptr;
+}
+
+std::uint32_t InjectionChannel::GetSlotCount() const {
+  return header_ ? header_->slot_count : 0;
+}
+
+void InjectionChannel::SetTickLimit(std::uint32_t limit) {
+  tick_limit_ = limit;
+}
+
+void InjectionChannel::Process(RakServer &rakserver) {
+  if (!header_) {
+    return;
+  }
+
+  const auto slot_count = header_->slot_count;
+
+  auto pos = header_->dequeue_pos.load(std::memory_order_relaxed);
+
+  for (std::uint32_t number{}; number < tick_limit_; number++) {
+    auto &slot = *reinterpret_cast<InjectionSlot *>(
+        slots_ + std::size_t{pos & (slot_count - 1)} * kSlotSize);
+
+    if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+      break;
+    }
+
+    switch (Run(rakserver, slot)) {
+      case Result::kProcessed:
+        header_->processed.fetch_add(1, std::memory_order_relaxed);
+        break;
+      case Result::kRejected:
+        header_->rejected.fetch_add(1, std::memory_order_relaxed);
+        break;
+      case Result::kThrottled:
+        header_->throttled.fetch_add(1, std::memory_order_relaxed);
+        break;
+    }
+
+    slot.sequence.store(pos + slot_count, std::memory_order_release);
+
+    header_->dequeue_pos.store(++pos, std::memory_order_relaxed);
+  }
+}
+
+std::uint32_t InjectionChannel::GetProcessed() const {
+  return header_ ? header_->processed.load(std::memory_order_relaxed) : 0;
+}
+
+std::uint32_t InjectionChannel::GetRejected() const {
+  return header_ ? header_->rejected.load(std::memory_order_relaxed) : 0;
+}
+
+std::uint32_t InjectionChannel::GetThrottled() const {
+  return header_ ? header_->throttled.load(std::memory_order_relaxed) : 0;
+}
+
+InjectionChannel::Result InjectionChannel::Run(RakServer &rakserver,
+                                               const InjectionSlot &slot) {
+  const std::uint32_t size = BITS_TO_BYTES(slot.number_of_bits);
+  if (!size || size > kSlotSize - sizeof(InjectionSlot)) {
+    return Result::kRejected;
+  }
+
+  if (slot.priority > PR_LOW_PRIORITY || slot.reliability < PR_UNRELIABLE ||
+      slot.reliability > PR_RELIABLE_SEQUENCED) {
+    return Result::kRejected;
+  }
+
+  const bool broadcast = slot.player_id == kInjectionBroadcast;
+  const int player_id = broadcast ? -1 : slot.player_id;
+
+  const auto player = broadcast ? UNASSIGNED_PLAYER_ID
+                                : rakserver.GetPlayerIDFromIndex(player_id);
+  if (!broadcast &&
+      player.binaryAddress == UNASSIGNED_PLAYER_ID.binaryAddress) {
+    return Result::kRejected;
+  }
+
+  // the stream only borrows the slot, everything below copies what it keeps
+  BitStream bs{const_cast<unsigned char *>(
+                   reinterpret_cast<const unsigned char *>(&slot + 1)),
+               size, false};
+  bs.SetWriteOffset(slot.number_of_bits);
+
+  auto &plugin = Plugin::Get();
+  auto &monitor = plugin.GetBandwidthMonitor();
+
+  RPCIndex rpc_id = slot.id;
+
+  switch (slot.command) {
+    case kInjectionSendPacket: {
+      if (!monitor.Admit(player_id, PR_OUTGOING_PACKET, *bs.GetData(), &bs,
+                         slot.priority, slot.reliability,
+                         slot.ordering_channel)) {
+        return Result::kThrottled;
+      }
+
+      rakserver.Send(&bs, slot.priority, slot.reliability,
+                     slot.ordering_channel, player, broadcast);
+
+      return Result::kProcessed;
+    }
+    case kInjectionSendRPC: {
+      if (!monitor.Admit(player_id, PR_OUTGOING_RPC, rpc_id, &bs,
+                         slot.priority, slot.reliability,
+                         slot.ordering_channel)) {
+        return Result::kThrottled;
+      }
+
+      rakserver.RPC(&rpc_id, &bs, slot.priority, slot.reliability,
+                    slot.ordering_channel, player, broadcast, false);
+
+      return Result::kProcessed;
+    }
+    case kInjectionEmulatePacket: {
+      if (broadcast) {
+        return Result::kRejected;
+      }
+
+      return plugin.PushPacketToEmulate(plugin.NewPacket(player_id, bs))
+                 ? Result::kProcessed
+                 : Result::kRejected;
+    }
+    case kInjectionEmulateRPC: {
+      if (broadcast || !plugin.GetOriginalRPCHandler(rpc_id)) {
+        return Result::kRejected;
+      }
+
+      return plugin.GetRPCEmulationQueue().Push(rpc_id, player, bs)
+                 ? Result::kProcessed
+                 : Result::kRejected;
+    }
+  }
+
+  return Result::kRejected;
+}
@@ -0,0 +1,69 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PAWNRAKNET_INJECTION_CHANNEL_H_
+#define PAWNRAKNET_INJECTION_CHANNEL_H_
+
+// Packets and rpcs pushed by external processes through a named shared
+// memory queue (see injection_channel_layout.h), run every server tick
+class InjectionChannel {
+ public:
+  static constexpr std::uint32_t kSlotSize = 2048;
+
+  ~InjectionChannel();
+
+  void Open(const std::string &name, std::uint32_t slot_count);
+
+  void Close();
+
+  bool IsOpen() const { return header_ != nullptr; }
+
+  const std::string &GetName() const { return memory_.GetName(); }
+
+  std::uint32_t GetSlotCount() const;
+
+  void SetTickLimit(std::uint32_t limit);
+
+  void Process(RakServer &rakserver);
+
+  std::uint32_t GetProcessed() const;
+
+  std::uint32_t GetRejected() const;
+
+  std::uint32_t GetThrottled() const;
+
+ private:
+  enum class Result { kProcessed, kRejected, kThrottled };
+
+  Result Run(RakServer &rakserver, const InjectionSlot &slot);
+
+  SharedMemory memory_;
+
+  InjectionChannelHeader *header_{};
+  unsigned char *slots_{};
+
+  std::uint32_t tick_limit_{256};
+};
+
+#endif  // PAWNRAKNET_INJECTION_CHANNEL_H_
@@ -0,0 +1,95 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PAWNRAKNET_INJECTION_CHANNEL_LAYOUT_H_
+#define PAWNRAKNET_INJECTION_CHANNEL_LAYOUT_H_
+
+// Layout of the injection channel shared memory. External producers include
+// this file as it is (see tools/packet_injector), so it only depends on the
+// standard library.
+//
+// The mapping is an InjectionChannelHeader followed by `slot_count` slots of
+// `slot_size` bytes at offset `header_size`. Each slot is an InjectionSlot
+// followed by the payload. Any number of producers may push, the server is
+// the only consumer (a bounded queue with per-slot sequence numbers):
+//
+// - slot i starts with sequence i;
+// - a producer loads pos = enqueue_pos, and the slot pos % slot_count is
+//   free when its sequence equals pos. The producer claims it by moving
+//   enqueue_pos from pos to pos + 1 (compare-and-swap, retry on failure),
+//   fills it and then stores sequence = pos + 1;
+// - the server takes the slot when its sequence equals dequeue_pos + 1 and
+//   gives it back by storing sequence = dequeue_pos + slot_count.
+//
+// All positions are 32-bit counters that wrap around. A producer that dies
+// between claiming and publishing a slot stalls the channel until the server
+// reopens it.
+
+#include <atomic>
+#include <cstdint>
+
+constexpr std::uint32_t kInjectionChannelMagic = 0x4A4E4950;  // "PINJ"
+constexpr std::uint32_t kInjectionChannelVersion = 2;
+constexpr std::uint16_t kInjectionBroadcast = 0xFFFF;
+
+enum InjectionCommand : std::uint8_t {
+  kInjectionSendPacket,     // RakServer::Send to player_id
+  kInjectionSendRPC,        // RakServer::RPC to player_id
+  kInjectionEmulatePacket,  // as if player_id had sent the packet
+  kInjectionEmulateRPC      // as if player_id had sent the rpc
+};
+
+struct InjectionChannelHeader {
+  std::uint32_t magic;
+  std::uint32_t version;
+  std::uint32_t slot_count;  // power of two
+  std::uint32_t slot_size;   // InjectionSlot included
+  std::uint32_t header_size;
+
+  std::atomic<std::uint32_t> processed;  // entries the server has run
+  std::atomic<std::uint32_t> rejected;   // invalid entries or full queues
+  std::atomic<std::uint32_t> throttled;  // sends dropped or deferred by the
+                                         // bandwidth budget
+
+  alignas(64) std::atomic<std::uint32_t> enqueue_pos;  // producers
+  alignas(64) std::atomic<std::uint32_t> dequeue_pos;  // the server
+};
+
+struct InjectionSlot {
+  std::atomic<std::uint32_t> sequence;
+  std::uint8_t command;  // InjectionCommand
+  std::uint8_t id;       // rpc id, unused for packets
+  std::uint8_t priority;
+  std::uint8_t reliability;
+  std::uint8_t ordering_channel;
+  std::uint8_t reserved;
+  std::uint16_t player_id;  // kInjectionBroadcast to send to everyone
+  std::uint32_t number_of_bits;
+};
+
+static_assert(sizeof(InjectionSlot) == 16, "InjectionSlot layout");
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free,
+              "InjectionChannelHeader positions have to be lock-free");
+
+#endif  // PAWNRAKNET_INJECTION_CHANNEL_LAYOUT_H_
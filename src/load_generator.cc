@@ -0,0 +1,335 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "main.h"
+
+void LoadGenerator::StartWalk(int player_id, const Vector3 &center,
+                              float radius, int rate,
+                              std::uint16_t vehicle_id) {
+  if (!(radius >= 0.0f)) {
+    throw std::runtime_error{"Invalid radius"};
+  }
+
+  auto &player = Add(player_id, Mode::kWalk, rate, vehicle_id, center);
+
+  player.center = center;
+  player.radius = radius;
+}
+
+void LoadGenerator::StartPath(int player_id, std::vector<Vector3> points,
+                              float speed, int rate,
+                              std::uint16_t vehicle_id) {
+  if (points.empty()) {
+    throw std::runtime_error{"Path is empty"};
+  }
+
+  if (!(speed >= 0.0f)) {
+    throw std::runtime_error{"Invalid speed"};
+  }
+
+  auto &player = Add(player_id, Mode::kPath, rate, vehicle_id, points.front());
+
+  player.points = std::move(points);
+  player.speed = speed;
+}
+
+void LoadGenerator::StartReplay(int player_id, const std::string &file_path,
+                                int recorded_player_id) {
+  CheckPlayerId(recorded_player_id);
+
+  auto reader = std::make_unique<DemoReader>();
+
+  reader->Open(file_path);
+
+  auto &player = Add(player_id, Mode::kReplay, 1, 0, {});
+
+  player.reader = std::move(reader);
+  player.recorded_player_id = recorded_player_id;
+  player.replay_started_at = Tracer::Now();
+}
+
+bool LoadGenerator::Stop(int player_id) {
+  if (player_id == -1) {
+    players_.clear();
+
+    return true;
+  }
+
+  return players_.erase(player_id) != 0;
+}
+
+void LoadGenerator::Process() {
+  if (players_.empty()) {
+    return;
+  }
+
+  stats_.ticks++;
+
+  const auto now = Tracer::Now();
+
+  for (auto &[player_id, player] : players_) {
+    if (player.mode == Mode::kReplay) {
+      Replay(player_id, player, now);
+
+      continue;
+    }
+
+    // the server has stalled, carry on from now instead of catching up
+    if (now - player.next_at > kMaxLag) {
+      player.next_at = now;
+    }
+
+    for (; player.next_at <= now; player.next_at += player.interval) {
+      const float seconds = player.interval / 1e6f;
+
+      if (player.mode == Mode::kWalk) {
+        Walk(player, seconds);
+      } else {
+        auto position = player.frame.position;
+        auto remaining = player.speed * seconds;
+
+        // a path of one point or of the same point is walked once per step
+        for (std::size_t i{}; remaining > 0.0f && i <= player.points.size();
+             i++) {
+          const auto &target = player.points[player.target];
+
+          const float dx = target[0] - position[0];
+          const float dy = target[1] - position[1];
+          const float dz = target[2] - position[2];
+          const float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+          if (distance <= remaining) {
+            position = target;
+            remaining -= distance;
+            player.target = (player.target + 1) % player.points.size();
+
+            continue;
+          }
+
+          const float t = remaining / distance;
+
+          position = {position[0] + dx * t, position[1] + dy * t,
+                      position[2] + dz * t};
+          remaining = 0.0f;
+        }
+
+        MoveTo(player, position, seconds);
+      }
+
+      Emit(player_id, player.frame);
+    }
+  }
+}
+
+LoadGenerator::Stats LoadGenerator::GetStats() const {
+  auto stats = stats_;
+
+  stats.players = static_cast<std::uint32_t>(players_.size());
+
+  return stats;
+}
+
+void LoadGenerator::CheckPlayerId(int player_id) {
+  if (player_id < 0 || player_id >= PR_MAX_PLAYERS) {
+    throw std::runtime_error{"Invalid player id " + std::to_string(player_id)};
+  }
+}
+
+std::int64_t LoadGenerator::GetInterval(int rate) {
+  if (rate < 1 || rate > 1000) {
+    throw std::runtime_error{"Invalid rate"};
+  }
+
+  return 1000000 / rate;
+}
+
+LoadGenerator::VirtualPlayer &LoadGenerator::Add(int player_id, Mode mode,
+                                                 int rate,
+                                                 std::uint16_t vehicle_id,
+                                                 const Vector3 &position) {
+  CheckPlayerId(player_id);
+
+  const auto interval = GetInterval(rate);
+
+  auto &player = players_[player_id];
+
+  player = {};
+  player.mode = mode;
+  player.interval = interval;
+  player.next_at = Tracer::Now();
+
+  auto &frame = player.frame;
+
+  frame.in_car = vehicle_id != 0;
+  frame.vehicle_id = vehicle_id;
+  frame.position = position;
+  frame.quaternion = {1.0f, 0.0f, 0.0f, 0.0f};
+  frame.health = 100;
+  frame.vehicle_health = 1000;
+
+  return player;
+}
+
+void LoadGenerator::Walk(VirtualPlayer &player, float seconds) {
+  std::uniform_real_distribution<float> turn{-0.5f, 0.5f};
+
+  const auto &position = player.frame.position;
+
+  const float dx = position[0] - player.center[0];
+  const float dy = position[1] - player.center[1];
+
+  if (dx * dx + dy * dy > player.radius * player.radius) {
+    player.heading = std::atan2(-dy, -dx);
+  } else {
+    player.heading += turn(random_);
+  }
+
+  const float step =
+      (player.frame.in_car ? kDriveSpeed : kWalkSpeed) * seconds;
+
+  MoveTo(player,
+         {position[0] + std::cos(player.heading) * step,
+          position[1] + std::sin(player.heading) * step, position[2]},
+         seconds);
+}
+
+void LoadGenerator::MoveTo(VirtualPlayer &player, const Vector3 &position,
+                           float seconds) {
+  // up on the keypad, the way a walking or driving client sends it
+  constexpr std::uint16_t kKeyUp = 0xFF80;
+
+  auto &frame = player.frame;
+
+  const float dx = position[0] - frame.position[0];
+  const float dy = position[1] - frame.position[1];
+  const float dz = position[2] - frame.position[2];
+
+  const bool moving = dx != 0.0f || dy != 0.0f;
+
+  // the sync velocity is in units per 1/50 of a second
+  const float scale = seconds > 0.0f ? 1.0f / (seconds * 50.0f) : 0.0f;
+
+  frame.velocity = {dx * scale, dy * scale, dz * scale};
+  frame.position = position;
+  frame.ud_key = moving ? kKeyUp : 0;
+
+  if (moving) {
+    // rotation around z, the models face +y
+    const float angle = std::atan2(dy, dx) - 1.5707964f;
+
+    frame.quaternion = {std::cos(angle / 2), 0.0f, 0.0f, std::sin(angle / 2)};
+  }
+}
+
+void LoadGenerator::Replay(int player_id, VirtualPlayer &player,
+                           std::int64_t now) {
+  auto &reader = *player.reader;
+
+  const auto time =
+      static_cast<std::uint32_t>((now - player.replay_started_at) / 1000);
+
+  for (; reader.HasFrame() && reader.GetTime() <= time; reader.Next()) {
+    if (reader.GetPlayerId() == player.recorded_player_id) {
+      Emit(player_id, reader.GetFrame());
+    }
+  }
+
+  if (!reader.HasFrame()) {
+    reader.Seek(0);
+
+    player.replay_started_at = now;
+  }
+}
+
+void LoadGenerator::Emit(int player_id, const DemoCodec::Frame &frame) {
+  auto &plugin = Plugin::Get();
+
+  BitStream bs;
+
+  WriteFrame(bs, frame);
+
+  if (plugin.PushPacketToEmulate(plugin.NewPacket(player_id, bs))) {
+    stats_.generated++;
+  } else {
+    stats_.dropped++;
+  }
+}
+
+void LoadGenerator::WriteFrame(BitStream &bs, const DemoCodec::Frame &frame) {
+  const std::uint8_t additional_key{};
+
+  bs.Write(frame.in_car ? kVehicleSyncId : kPlayerSyncId);
+
+  if (frame.in_car) {
+    bs.Write(frame.vehicle_id);
+  }
+
+  bs.Write(frame.lr_key);
+  bs.Write(frame.ud_key);
+  bs.Write(frame.keys);
+
+  if (frame.in_car) {
+    for (const auto component : frame.quaternion) {
+      bs.Write(component);
+    }
+    for (const auto component : frame.position) {
+      bs.Write(component);
+    }
+    for (const auto component : frame.velocity) {
+      bs.Write(component);
+    }
+    bs.Write(static_cast<float>(frame.vehicle_health));
+    bs.Write(frame.health);
+    bs.Write(frame.armour);
+    bs.WriteBits(&additional_key, 2);
+    bs.WriteBits(&frame.weapon_id, 6);
+    bs.Write(std::uint8_t{});   // siren
+    bs.Write(std::uint8_t{});   // landing gear
+    bs.Write(std::uint16_t{});  // trailer
+    bs.Write(0.0f);             // train speed
+
+    return;
+  }
+
+  for (const auto component : frame.position) {
+    bs.Write(component);
+  }
+  for (const auto component : frame.quaternion) {
+    bs.Write(component);
+  }
+  bs.Write(frame.health);
+  bs.Write(frame.armour);
+  bs.WriteBits(&additional_key, 2);
+  bs.WriteBits(&frame.weapon_id, 6);
+  bs.Write(frame.special_action);
+  for (const auto component : frame.velocity) {
+    bs.Write(component);
+  }
+  for (std::size_t i{}; i < 3; i++) {
+    bs.Write(0.0f);  // surfing offsets
+  }
+  bs.Write(std::uint16_t{});  // surfing vehicle
+  bs.Write(frame.animation_id);
+  bs.Write(frame.animation_flags);
+}
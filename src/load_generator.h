@@ -0,0 +1,115 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PAWNRAKNET_LOAD_GENERATOR_H_
+#define PAWNRAKNET_LOAD_GENERATOR_H_
+
+// Synthesizes incoming on-foot/in-car sync of virtual players for load tests
+// and hands it to the server like PR_EmulateIncomingPacket, from
+// OnProcessTick. The player ids have to be connected (e.g. NPCs) for the
+// server to process the sync
+class LoadGenerator {
+ public:
+  using Vector3 = std::array<float, 3>;
+
+  struct Stats {
+    std::uint32_t players{};
+    std::uint32_t generated{};
+    std::uint32_t dropped{};  // the emulation queue was full
+    std::uint32_t ticks{};    // server ticks while generating
+  };
+
+  // Random walk around the center, rate is syncs per second. Vehicle id 0
+  // makes on-foot sync
+  void StartWalk(int player_id, const Vector3 &center, float radius, int rate,
+                 std::uint16_t vehicle_id);
+
+  // Loops over the points at speed meters per second
+  void StartPath(int player_id, std::vector<Vector3> points, float speed,
+                 int rate, std::uint16_t vehicle_id);
+
+  // Loops over the sync of recorded_player_id in a demo, with its timing
+  void StartReplay(int player_id, const std::string &file_path,
+                   int recorded_player_id);
+
+  // -1 stops all of them
+  bool Stop(int player_id);
+
+  void Process();
+
+  Stats GetStats() const;
+
+ private:
+  enum class Mode { kWalk, kPath, kReplay };
+
+  static constexpr unsigned char kVehicleSyncId = 200;
+  static constexpr unsigned char kPlayerSyncId = 207;
+
+  static constexpr float kWalkSpeed = 5.0f;      // meters per second
+  static constexpr float kDriveSpeed = 20.0f;
+  static constexpr std::int64_t kMaxLag = 1000000;  // microseconds
+
+  struct VirtualPlayer {
+    Mode mode{};
+    std::int64_t interval{};  // microseconds
+    std::int64_t next_at{};
+    DemoCodec::Frame frame;
+
+    Vector3 center{};
+    float radius{};
+    float heading{};
+
+    std::vector<Vector3> points;
+    std::size_t target{};
+    float speed{};
+
+    std::unique_ptr<DemoReader> reader;
+    int recorded_player_id{};
+    std::int64_t replay_started_at{};
+  };
+
+  static void CheckPlayerId(int player_id);
+
+  static std::int64_t GetInterval(int rate);
+
+  VirtualPlayer &Add(int player_id, Mode mode, int rate,
+                     std::uint16_t vehicle_id, const Vector3 &position);
+
+  void Walk(VirtualPlayer &player, float seconds);
+
+  static void MoveTo(VirtualPlayer &player, const Vector3 &position,
+                     float seconds);
+
+  void Replay(int player_id, VirtualPlayer &player, std::int64_t now);
+
+  void Emit(int player_id, const DemoCodec::Frame &frame);
+
+  static void WriteFrame(BitStream &bs, const DemoCodec::Frame &frame);
+
+  std::unordered_map<int, VirtualPlayer> players_;
+  std::mt19937 random_{std::random_device{}()};
+  Stats stats_;
+};
+
+#endif  // PAWNRAKNET_LOAD_GENERATOR_H_
@@ -33,16 +33,33 @@
 #include "cpptoml/include/cpptoml.h"
 
 #include <unordered_set>
+#include <unordered_map>
 #include <set>
 #include <limits>
 #include <list>
 #include <array>
 #include <string>
 #include <regex>
-#include <queue>
+#include <deque>
 #include <thread>
 #include <atomic>
 #include <vector>
+#include <cstdint>
+#include <chrono>
+#include <algorithm>
+#include <mutex>
+#include <fstream>
+#include <csignal>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <bitset>
+#include <string_view>
+#include <sstream>
+#include <map>
+
+#include <sys/types.h>
+#include <sys/stat.h>
 
 #include "Pawn.RakNet.inc"
 
@@ -57,9 +74,35 @@
 #endif
 
 #include "config.h"
+#include "packet_tap_layout.h"
+#include "injection_channel_layout.h"
+#include "demo_layout.h"
+#include "shared_memory.h"
+#include "ring_buffer.h"
+#include "tracer.h"
+#include "bitstream_table.h"
 #include "bitstream_pool.h"
 #include "internal_packet_channel.h"
+#include "packet_batch.h"
 #include "rakserver.h"
+#include "handler_sampler.h"
+#include "handler_table.h"
+#include "packet_template.h"
+#include "bandwidth_monitor.h"
+#include "send_scheduler.h"
+#include "rpc_emulation_queue.h"
+#include "packet_tap.h"
+#include "injection_channel.h"
+#include "sync_store.h"
+#include "movement_validator.h"
+#include "bullet_validator.h"
+#include "demo_codec.h"
+#include "demo_recorder.h"
+#include "demo_reader.h"
+#include "demo_player.h"
+#include "load_generator.h"
+#include "markers_sync.h"
+#include "string_cache.h"
 #include "script.h"
 #include "native_param.h"
 #include "plugin.h"
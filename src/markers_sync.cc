@@ -0,0 +1,233 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "main.h"
+
+void MarkersSync::SetVisible(int for_player_id, const PlayerID &for_player,
+                             int player_id, bool visible) {
+  if (for_player_id < 0 || for_player_id >= PR_MAX_PLAYERS) {
+    throw std::runtime_error{"Invalid player id " +
+                             std::to_string(for_player_id)};
+  }
+
+  if (player_id < -1 || player_id >= PR_MAX_PLAYERS) {
+    throw std::runtime_error{"Invalid player id " + std::to_string(player_id)};
+  }
+
+  Claim(for_player_id, for_player);
+
+  auto &hidden = hidden_[for_player_id];
+
+  if (player_id == -1) {
+    if (visible) {
+      hidden.reset();
+    } else {
+      hidden.set();
+    }
+
+    return;
+  }
+
+  hidden.set(player_id, !visible);
+}
+
+int MarkersSync::Send(RakServer &rakserver, BandwidthMonitor &monitor,
+                      const SyncStore &sync_store, float radius, int priority,
+                      int reliability, char ordering_channel) {
+  if (!(radius >= 0.0f)) {
+    throw std::runtime_error{"Invalid radius"};
+  }
+
+  std::array<bool, PR_MAX_PLAYERS> connected{};
+
+  cells_.clear();
+
+  for (int i{}; i < PR_MAX_PLAYERS; i++) {
+    const auto player = rakserver.GetPlayerIDFromIndex(i);
+
+    connected[i] = player.binaryAddress != UNASSIGNED_PLAYER_ID.binaryAddress;
+    if (!connected[i]) {
+      has_position_[i] = false;
+
+      continue;
+    }
+
+    Claim(i, player);
+
+    has_position_[i] = sync_store.GetLastPosition(i, player, positions_[i]);
+    if (has_position_[i] && radius > 0.0f) {
+      cells_.emplace_back(GetCellKey(GetCell(positions_[i][0], radius),
+                                     GetCell(positions_[i][1], radius)),
+                          static_cast<std::uint16_t>(i));
+    }
+  }
+
+  std::sort(cells_.begin(), cells_.end());
+
+  int recipients{};
+
+  for (int i{}; i < PR_MAX_PLAYERS; i++) {
+    if (!connected[i]) {
+      continue;
+    }
+
+    CollectNeighbours(i, radius);
+
+    auto &sent = sent_[i];
+
+    if (neighbours_.empty() && sent.empty()) {
+      continue;
+    }
+
+    bs_.Reset();
+    bs_.Write(kMarkersSyncId);
+    bs_.Write(std::int32_t{});  // patched below
+
+    std::int32_t number_of_players{};
+
+    for (const auto player_id : neighbours_) {
+      const auto &position = positions_[player_id];
+
+      bs_.Write(player_id);
+      bs_.WriteCompressed(true);
+      bs_.Write(Clamp(position[0]));
+      bs_.Write(Clamp(position[1]));
+      bs_.Write(Clamp(position[2]));
+
+      number_of_players++;
+    }
+
+    // the ones that went out of range or got hidden
+    for (const auto player_id : sent) {
+      if (is_neighbour_.test(player_id)) {
+        continue;
+      }
+
+      bs_.Write(player_id);
+      bs_.WriteCompressed(false);
+
+      number_of_players++;
+    }
+
+    std::memcpy(bs_.GetData() + sizeof(kMarkersSyncId), &number_of_players,
+                sizeof(number_of_players));
+
+    for (const auto player_id : neighbours_) {
+      is_neighbour_.reset(player_id);
+    }
+
+    sent = neighbours_;
+
+    if (monitor.Admit(i, PR_OUTGOING_PACKET, kMarkersSyncId, &bs_, priority,
+                      reliability, ordering_channel)) {
+      rakserver.Send(&bs_, priority, reliability, ordering_channel, owners_[i],
+                     false);
+
+      recipients++;
+    }
+  }
+
+  return recipients;
+}
+
+std::uint64_t MarkersSync::GetCellKey(std::int32_t x, std::int32_t y) {
+  return static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32 |
+         static_cast<std::uint32_t>(y);
+}
+
+std::int32_t MarkersSync::GetCell(float value, float cell_size) {
+  const float cell = std::floor(value / cell_size);
+
+  return static_cast<std::int32_t>(std::max(-1e9f, std::min(cell, 1e9f)));
+}
+
+std::int16_t MarkersSync::Clamp(float value) {
+  return static_cast<std::int16_t>(
+      std::max(-32768.0f, std::min(value, 32767.0f)));
+}
+
+void MarkersSync::Claim(int player_id, const PlayerID &player) {
+  auto &owner = owners_[player_id];
+  if (owner.binaryAddress == player.binaryAddress &&
+      owner.port == player.port) {
+    return;
+  }
+
+  owner = player;
+  hidden_[player_id].reset();
+  sent_[player_id].clear();
+}
+
+void MarkersSync::CollectNeighbours(int player_id, float radius) {
+  neighbours_.clear();
+
+  const auto &hidden = hidden_[player_id];
+
+  const auto add = [&](int other_id) {
+    if (other_id == player_id || hidden.test(other_id)) {
+      return;
+    }
+
+    neighbours_.push_back(static_cast<std::uint16_t>(other_id));
+    is_neighbour_.set(other_id);
+  };
+
+  if (radius == 0.0f) {
+    for (int other_id{}; other_id < PR_MAX_PLAYERS; other_id++) {
+      if (has_position_[other_id]) {
+        add(other_id);
+      }
+    }
+
+    return;
+  }
+
+  if (!has_position_[player_id]) {
+    return;
+  }
+
+  const auto &position = positions_[player_id];
+  const auto cell_x = GetCell(position[0], radius);
+  const auto cell_y = GetCell(position[1], radius);
+
+  for (std::int32_t x = cell_x - 1; x <= cell_x + 1; x++) {
+    for (std::int32_t y = cell_y - 1; y <= cell_y + 1; y++) {
+      const auto key = GetCellKey(x, y);
+
+      auto iter = std::lower_bound(
+          cells_.begin(), cells_.end(), std::make_pair(key, std::uint16_t{}));
+
+      for (; iter != cells_.end() && iter->first == key; ++iter) {
+        const auto &other = positions_[iter->second];
+
+        const float dx = other[0] - position[0];
+        const float dy = other[1] - position[1];
+
+        if (dx * dx + dy * dy <= radius * radius) {
+          add(iter->second);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,81 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PAWNRAKNET_MARKERS_SYNC_H_
+#define PAWNRAKNET_MARKERS_SYNC_H_
+
+// Builds and sends the markers sync (map markers of the other players) of
+// every connected player in one pass. Players are bucketed into a grid of
+// radius-sized cells, so a recipient only looks at the 3x3 cells around it.
+// A recipient gets the players in range as active and the ones it was sent
+// last time but no longer sees as inactive, nothing else
+class MarkersSync {
+ public:
+  // player_id -1 means all players
+  void SetVisible(int for_player_id, const PlayerID &for_player,
+                  int player_id, bool visible);
+
+  // Radius 0 shows everyone to everyone. Returns the number of recipients
+  int Send(RakServer &rakserver, BandwidthMonitor &monitor,
+           const SyncStore &sync_store, float radius, int priority,
+           int reliability, char ordering_channel);
+
+ private:
+  static constexpr unsigned char kMarkersSyncId = 208;
+
+  using Vector3 = std::array<float, 3>;
+
+  template <typename T>
+  using PerPlayer = std::array<T, PR_MAX_PLAYERS>;
+
+  static std::uint64_t GetCellKey(std::int32_t x, std::int32_t y);
+
+  static std::int32_t GetCell(float value, float cell_size);
+
+  static std::int16_t Clamp(float value);
+
+  // Forgets the visibility and the sent markers of the previous player with
+  // the id
+  void Claim(int player_id, const PlayerID &player);
+
+  void CollectNeighbours(int player_id, float radius);
+
+  PerPlayer<PlayerID> owners_{};
+  PerPlayer<std::bitset<PR_MAX_PLAYERS>> hidden_{};
+  PerPlayer<std::vector<std::uint16_t>> sent_{};
+
+  PerPlayer<bool> has_position_{};
+  PerPlayer<Vector3> positions_{};
+
+  // (cell key, player id) of the players with a position, sorted
+  std::vector<std::pair<std::uint64_t, std::uint16_t>> cells_;
+
+  // scratch space of the recipient being built
+  std::vector<std::uint16_t> neighbours_;
+  std::bitset<PR_MAX_PLAYERS> is_neighbour_;
+
+  BitStream bs_;
+};
+
+#endif  // PAWNRAKNET_MARKERS_SYNC_H_
@@ -0,0 +1,360 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "main.h"
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || \
+    defined(_M_X64)
+#define PAWNRAKNET_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#ifdef __GNUC__
+#define PAWNRAKNET_TARGET(name) __attribute__((target(name)))
+#else
+#define PAWNRAKNET_TARGET(name)
+#endif
+
+void MovementValidator::SetLimits(const Limits &limits) { limits_ = limits; }
+
+const MovementValidator::Limits &MovementValidator::GetLimits() const {
+  return limits_;
+}
+
+bool MovementValidator::IsEnabled() const {
+  return limits_.max_speed > 0 || limits_.max_acceleration > 0 ||
+         limits_.max_distance > 0;
+}
+
+void MovementValidator::Record(int player_id, const PlayerID &player,
+                               const std::array<float, 3> &position,
+                               const std::array<float, 3> &velocity) {
+  if (player_id < 0 || player_id >= PR_MAX_PLAYERS) {
+    return;
+  }
+
+  const std::size_t i = player_id;
+
+  if (owners_[i].binaryAddress != player.binaryAddress ||
+      owners_[i].port != player.port) {
+    owners_[i] = player;
+    sampled_at_[i] = 0;
+    has_prev_[i] = false;
+    fresh_[i] = false;
+  }
+
+  // samples received between two checks are checked as one step, from the
+  // sample of the last check to the newest one
+  if (!fresh_[i] && sampled_at_[i]) {
+    prev_x_[i] = x_[i];
+    prev_y_[i] = y_[i];
+    prev_z_[i] = z_[i];
+    prev_vx_[i] = vx_[i];
+    prev_vy_[i] = vy_[i];
+    prev_vz_[i] = vz_[i];
+    prev_sampled_at_[i] = sampled_at_[i];
+    has_prev_[i] = true;
+  }
+
+  x_[i] = position[0];
+  y_[i] = position[1];
+  z_[i] = position[2];
+  vx_[i] = velocity[0];
+  vy_[i] = velocity[1];
+  vz_[i] = velocity[2];
+  sampled_at_[i] = Tracer::Now();
+  fresh_[i] = true;
+}
+
+bool MovementValidator::Evaluate() {
+  violations_.clear();
+
+  if (!IsEnabled()) {
+    return false;
+  }
+
+  bool any_fresh{};
+
+  for (std::size_t i{}; i < kLanes; i++) {
+    if (!fresh_[i]) {
+      continue;
+    }
+
+    any_fresh = true;
+
+    dt_[i] = has_prev_[i]
+                 ? std::max((sampled_at_[i] - prev_sampled_at_[i]) / 1e6f,
+                            1e-3f)
+                 : 0.0f;
+  }
+
+  if (!any_fresh) {
+    return false;
+  }
+
+  constexpr auto kInfinity = std::numeric_limits<float>::infinity();
+
+  Thresholds t{};
+  t.speed2 = limits_.max_speed > 0 ? limits_.max_speed * limits_.max_speed
+                                   : kInfinity;
+  t.acceleration =
+      limits_.max_acceleration > 0 ? limits_.max_acceleration : kInfinity;
+  t.distance2 = limits_.max_distance > 0
+                    ? limits_.max_distance * limits_.max_distance
+                    : kInfinity;
+
+#ifdef PAWNRAKNET_X86
+  static const auto kernel = [] {
+#ifdef __GNUC__
+    __builtin_cpu_init();
+
+    const bool avx2 = __builtin_cpu_supports("avx2");
+    const bool sse2 = __builtin_cpu_supports("sse2");
+#else
+    int info[4]{};
+
+    __cpuid(info, 1);
+
+    const bool sse2 = info[3] & (1 << 26);
+    const bool os_saves_ymm = (info[2] & (1 << 27)) &&
+                              (_xgetbv(0) & 0x6) == 0x6;
+
+    __cpuidex(info, 7, 0);
+
+    const bool avx2 = os_saves_ymm && (info[1] & (1 << 5));
+#endif
+    return avx2 ? 2 : sse2 ? 1 : 0;
+  }();
+
+  if (kernel == 2) {
+    EvaluateAVX2(*this, t, kLanes, flags_.data());
+  } else if (kernel == 1) {
+    EvaluateSSE2(*this, t, kLanes, flags_.data());
+  } else {
+    EvaluateScalar(*this, t, kLanes, flags_.data());
+  }
+#else
+  EvaluateScalar(*this, t, kLanes, flags_.data());
+#endif
+
+  for (std::size_t i{}; i < kLanes; i++) {
+    if (!fresh_[i]) {
+      continue;
+    }
+
+    fresh_[i] = false;
+
+    // the other checks compare against the previous sample
+    const int flags =
+        has_prev_[i] ? flags_[i]
+                     : flags_[i] & (PR_MOVEMENT_NON_FINITE | PR_MOVEMENT_SPEED);
+    if (flags) {
+      violations_.push_back({static_cast<int>(i), flags});
+    }
+  }
+
+  return !violations_.empty();
+}
+
+const std::vector<MovementValidator::Violation> &
+MovementValidator::GetViolations() const {
+  return violations_;
+}
+
+void MovementValidator::EvaluateScalar(const MovementValidator &v,
+                                       const Thresholds &t, std::size_t last,
+                                       std::uint8_t *flags) {
+  for (std::size_t i{}; i < last; i++) {
+    int f{};
+
+    if (!std::isfinite(v.x_[i]) || !std::isfinite(v.y_[i]) ||
+        !std::isfinite(v.z_[i]) || !std::isfinite(v.vx_[i]) ||
+        !std::isfinite(v.vy_[i]) || !std::isfinite(v.vz_[i])) {
+      f |= PR_MOVEMENT_NON_FINITE;
+    }
+
+    const auto speed2 =
+        v.vx_[i] * v.vx_[i] + v.vy_[i] * v.vy_[i] + v.vz_[i] * v.vz_[i];
+    if (speed2 > t.speed2) {
+      f |= PR_MOVEMENT_SPEED;
+    }
+
+    const auto dvx = v.vx_[i] - v.prev_vx_[i];
+    const auto dvy = v.vy_[i] - v.prev_vy_[i];
+    const auto dvz = v.vz_[i] - v.prev_vz_[i];
+    const auto max_dv = t.acceleration * v.dt_[i];
+    if (dvx * dvx + dvy * dvy + dvz * dvz > max_dv * max_dv) {
+      f |= PR_MOVEMENT_ACCELERATION;
+    }
+
+    const auto dx = v.x_[i] - v.prev_x_[i];
+    const auto dy = v.y_[i] - v.prev_y_[i];
+    const auto dz = v.z_[i] - v.prev_z_[i];
+    if (dx * dx + dy * dy + dz * dz > t.distance2) {
+      f |= PR_MOVEMENT_TELEPORT;
+    }
+
+    flags[i] = static_cast<std::uint8_t>(f);
+  }
+}
+
+#ifdef PAWNRAKNET_X86
+PAWNRAKNET_TARGET("sse2")
+void MovementValidator::EvaluateSSE2(const MovementValidator &v,
+                                     const Thresholds &t, std::size_t last,
+                                     std::uint8_t *flags) {
+  const auto speed2 = _mm_set1_ps(t.speed2);
+  const auto acceleration = _mm_set1_ps(t.acceleration);
+  const auto distance2 = _mm_set1_ps(t.distance2);
+
+  for (std::size_t i{}; i < last; i += 4) {
+    const auto x = _mm_load_ps(&v.x_[i]);
+    const auto y = _mm_load_ps(&v.y_[i]);
+    const auto z = _mm_load_ps(&v.z_[i]);
+    const auto vx = _mm_load_ps(&v.vx_[i]);
+    const auto vy = _mm_load_ps(&v.vy_[i]);
+    const auto vz = _mm_load_ps(&v.vz_[i]);
+
+    // a - a is 0 for finite values and NaN for NaN and Inf, the sum keeps
+    // the NaN and NaN != NaN
+    const auto nan = _mm_add_ps(
+        _mm_add_ps(_mm_add_ps(_mm_sub_ps(x, x), _mm_sub_ps(y, y)),
+                   _mm_add_ps(_mm_sub_ps(z, z), _mm_sub_ps(vx, vx))),
+        _mm_add_ps(_mm_sub_ps(vy, vy), _mm_sub_ps(vz, vz)));
+    const auto non_finite = _mm_cmpneq_ps(nan, nan);
+
+    const auto speed = _mm_cmpgt_ps(
+        _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)),
+                   _mm_mul_ps(vz, vz)),
+        speed2);
+
+    const auto dvx = _mm_sub_ps(vx, _mm_load_ps(&v.prev_vx_[i]));
+    const auto dvy = _mm_sub_ps(vy, _mm_load_ps(&v.prev_vy_[i]));
+    const auto dvz = _mm_sub_ps(vz, _mm_load_ps(&v.prev_vz_[i]));
+    const auto max_dv = _mm_mul_ps(acceleration, _mm_load_ps(&v.dt_[i]));
+    const auto accel = _mm_cmpgt_ps(
+        _mm_add_ps(_mm_add_ps(_mm_mul_ps(dvx, dvx), _mm_mul_ps(dvy, dvy)),
+                   _mm_mul_ps(dvz, dvz)),
+        _mm_mul_ps(max_dv, max_dv));
+
+    const auto dx = _mm_sub_ps(x, _mm_load_ps(&v.prev_x_[i]));
+    const auto dy = _mm_sub_ps(y, _mm_load_ps(&v.prev_y_[i]));
+    const auto dz = _mm_sub_ps(z, _mm_load_ps(&v.prev_z_[i]));
+    const auto teleport = _mm_cmpgt_ps(
+        _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)),
+                   _mm_mul_ps(dz, dz)),
+        distance2);
+
+    const int masks[] = {
+        _mm_movemask_ps(non_finite), _mm_movemask_ps(speed),
+        _mm_movemask_ps(accel), _mm_movemask_ps(teleport)};
+
+    for (int lane{}; lane < 4; lane++) {
+      flags[i + lane] = static_cast<std::uint8_t>(
+          ((masks[0] >> lane) & 1) * PR_MOVEMENT_NON_FINITE |
+          ((masks[1] >> lane) & 1) * PR_MOVEMENT_SPEED |
+          ((masks[2] >> lane) & 1) * PR_MOVEMENT_ACCELERATION |
+          ((masks[3] >> lane) & 1) * PR_MOVEMENT_TELEPORT);
+    }
+  }
+}
+
+PAWNRAKNET_TARGET("avx2")
+void MovementValidator::EvaluateAVX2(const MovementValidator &v,
+                                     const Thresholds &t, std::size_t last,
+                                     std::uint8_t *flags) {
+  const auto speed2 = _mm256_set1_ps(t.speed2);
+  const auto acceleration = _mm256_set1_ps(t.acceleration);
+  const auto distance2 = _mm256_set1_ps(t.distance2);
+
+  for (std::size_t i{}; i < last; i += 8) {
+    const auto x = _mm256_load_ps(&v.x_[i]);
+    const auto y = _mm256_load_ps(&v.y_[i]);
+    const auto z = _mm256_load_ps(&v.z_[i]);
+    const auto vx = _mm256_load_ps(&v.vx_[i]);
+    const auto vy = _mm256_load_ps(&v.vy_[i]);
+    const auto vz = _mm256_load_ps(&v.vz_[i]);
+
+    const auto nan = _mm256_add_ps(
+        _mm256_add_ps(
+            _mm256_add_ps(_mm256_sub_ps(x, x), _mm256_sub_ps(y, y)),
+            _mm256_add_ps(_mm256_sub_ps(z, z), _mm256_sub_ps(vx, vx))),
+        _mm256_add_ps(_mm256_sub_ps(vy, vy), _mm256_sub_ps(vz, vz)));
+    const auto non_finite = _mm256_cmp_ps(nan, nan, _CMP_NEQ_UQ);
+
+    const auto speed = _mm256_cmp_ps(
+        _mm256_add_ps(
+            _mm256_add_ps(_mm256_mul_ps(vx, vx), _mm256_mul_ps(vy, vy)),
+            _mm256_mul_ps(vz, vz)),
+        speed2, _CMP_GT_OQ);
+
+    const auto dvx = _mm256_sub_ps(vx, _mm256_load_ps(&v.prev_vx_[i]));
+    const auto dvy = _mm256_sub_ps(vy, _mm256_load_ps(&v.prev_vy_[i]));
+    const auto dvz = _mm256_sub_ps(vz, _mm256_load_ps(&v.prev_vz_[i]));
+    const auto max_dv =
+        _mm256_mul_ps(acceleration, _mm256_load_ps(&v.dt_[i]));
+    const auto accel = _mm256_cmp_ps(
+        _mm256_add_ps(
+            _mm256_add_ps(_mm256_mul_ps(dvx, dvx), _mm256_mul_ps(dvy, dvy)),
+            _mm256_mul_ps(dvz, dvz)),
+        _mm256_mul_ps(max_dv, max_dv), _CMP_GT_OQ);
+
+    const auto dx = _mm256_sub_ps(x, _mm256_load_ps(&v.prev_x_[i]));
+    const auto dy = _mm256_sub_ps(y, _mm256_load_ps(&v.prev_y_[i]));
+    const auto dz = _mm256_sub_ps(z, _mm256_load_ps(&v.prev_z_[i]));
+    const auto teleport = _mm256_cmp_ps(
+        _mm256_add_ps(
+            _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)),
+            _mm256_mul_ps(dz, dz)),
+        distance2, _CMP_GT_OQ);
+
+    const int masks[] = {
+        _mm256_movemask_ps(non_finite), _mm256_movemask_ps(speed),
+        _mm256_movemask_ps(accel), _mm256_movemask_ps(teleport)};
+
+    for (int lane{}; lane < 8; lane++) {
+      flags[i + lane] = static_cast<std::uint8_t>(
+          ((masks[0] >> lane) & 1) * PR_MOVEMENT_NON_FINITE |
+          ((masks[1] >> lane) & 1) * PR_MOVEMENT_SPEED |
+          ((masks[2] >> lane) & 1) * PR_MOVEMENT_ACCELERATION |
+          ((masks[3] >> lane) & 1) * PR_MOVEMENT_TELEPORT);
+    }
+  }
+}
+#else
+void MovementValidator::EvaluateSSE2(const MovementValidator &v,
+                                     const Thresholds &t, std::size_t last,
+                                     std::uint8_t *flags) {
+  EvaluateScalar(v, t, last, flags);
+}
+
+void MovementValidator::EvaluateAVX2(const MovementValidator &v,
+                                     const Thresholds &t, std::size_t last,
+                                     std::uint8_t *flags) {
+  EvaluateScalar(v, t, last, flags);
+}
+#endif
@@ -0,0 +1,116 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PAWNRAKNET_MOVEMENT_VALIDATOR_H_
+#define PAWNRAKNET_MOVEMENT_VALIDATOR_H_
+
+// Speed, acceleration, teleport and NaN/Inf checks of the on-foot and in-car
+// sync of all players, run once per server tick over arrays of positions and
+// velocities (AVX2 or SSE2 when the CPU has them, scalar otherwise)
+class MovementValidator {
+ public:
+  struct Limits {
+    float max_speed{};         // length of the sync velocity
+    float max_acceleration{};  // velocity change per second
+    float max_distance{};      // between two checked samples
+  };
+
+  struct Violation {
+    int player_id{};
+    int flags{};  // PR_MovementViolation
+  };
+
+  // Zero disables a check, all zeros disable the validator
+  void SetLimits(const Limits &limits);
+
+  const Limits &GetLimits() const;
+
+  bool IsEnabled() const;
+
+  void Record(int player_id, const PlayerID &player,
+              const std::array<float, 3> &position,
+              const std::array<float, 3> &velocity);
+
+  // Checks the players who have sent sync since the last call, returns true
+  // if any of them is in violation
+  bool Evaluate();
+
+  const std::vector<Violation> &GetViolations() const;
+
+ private:
+  // a multiple of the AVX2 width, so the kernels never have a tail to handle
+  static constexpr std::size_t kLanes = (PR_MAX_PLAYERS + 7) & ~7;
+
+  template <typename T>
+  using Lanes = std::array<T, kLanes>;
+
+  // thresholds as the kernels compare them, +inf if the check is disabled
+  struct Thresholds {
+    float speed2{};
+    float acceleration{};
+    float distance2{};
+  };
+
+  static void EvaluateScalar(const MovementValidator &v, const Thresholds &t,
+                             std::size_t last, std::uint8_t *flags);
+
+  static void EvaluateSSE2(const MovementValidator &v, const Thresholds &t,
+                           std::size_t last, std::uint8_t *flags);
+
+  static void EvaluateAVX2(const MovementValidator &v, const Thresholds &t,
+                           std::size_t last, std::uint8_t *flags);
+
+  Limits limits_;
+
+  // current sample
+  alignas(32) Lanes<float> x_{};
+  alignas(32) Lanes<float> y_{};
+  alignas(32) Lanes<float> z_{};
+  alignas(32) Lanes<float> vx_{};
+  alignas(32) Lanes<float> vy_{};
+  alignas(32) Lanes<float> vz_{};
+
+  // sample of the last check
+  alignas(32) Lanes<float> prev_x_{};
+  alignas(32) Lanes<float> prev_y_{};
+  alignas(32) Lanes<float> prev_z_{};
+  alignas(32) Lanes<float> prev_vx_{};
+  alignas(32) Lanes<float> prev_vy_{};
+  alignas(32) Lanes<float> prev_vz_{};
+
+  // seconds between the samples
+  alignas(32) Lanes<float> dt_{};
+
+  Lanes<std::int64_t> sampled_at_{};  // steady clock, microseconds
+  Lanes<std::int64_t> prev_sampled_at_{};
+  Lanes<bool> has_prev_{};
+  Lanes<bool> fresh_{};
+  Lanes<PlayerID> owners_{};
+
+  alignas(32) Lanes<std::uint8_t> flags_{};
+
+  std::vector<Violation> violations_;
+};
+
+#endif  // PAWNRAKNET_MOVEMENT_VALIDATOR_H_
@@ -28,6 +28,8 @@
 struct NativeParam : Script::NativeParam {
   operator BitStream*() { return script.GetBitStream(raw_value); }
 
+  operator float() { return amx_ctof(raw_value); }
+
   operator RPCIndex() { return static_cast<RPCIndex>(raw_value); }
 
   operator PR_PacketPriority() {
@@ -39,6 +41,14 @@ struct NativeParam : Script::NativeParam {
   }
 
   operator PR_EventType() { return static_cast<PR_EventType>(raw_value); }
+
+  operator PR_BudgetAction() {
+    return static_cast<PR_BudgetAction>(raw_value);
+  }
+
+  operator PR_BulletAction() {
+    return static_cast<PR_BulletAction>(raw_value);
+  }
 };
 
 #endif  // PAWNRAKNET_NATIVE_PARAM_H_
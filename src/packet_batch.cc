@@ -0,0 +1,75 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "main.h"
+
+PacketBatch::Entry &PacketBatch::Add(Packet *packet) {
+  return entries_.emplace_back(packet);
+}
+
+Packet *PacketBatch::PopPacket() {
+  while (next_entry_ < entries_.size()) {
+    const auto &entry = entries_[next_entry_++];
+    if (entry.accepted) {
+      return entry.packet;
+    }
+  }
+
+  return nullptr;
+}
+
+bool PacketBatch::HasPendingPackets() {
+  return next_entry_ < entries_.size();
+}
+
+void PacketBatch::Clear() {
+  entries_.clear();
+  next_entry_ = 0;
+
+  view_.clear();
+}
+
+std::deque<PacketBatch::Entry> &PacketBatch::GetEntries() { return entries_; }
+
+std::size_t PacketBatch::MakeView() {
+  view_.clear();
+
+  for (auto &entry : entries_) {
+    if (entry.is_player_packet && entry.accepted) {
+      entry.bs.ResetReadPointer();
+
+      view_.push_back(&entry);
+    }
+  }
+
+  return view_.size();
+}
+
+PacketBatch::Entry *PacketBatch::GetViewEntry(std::size_t index) {
+  return index < view_.size() ? view_[index] : nullptr;
+}
+
+std::size_t PacketBatch::GetViewSize() { return view_.size(); }
+
+void PacketBatch::ClearView() { view_.clear(); }
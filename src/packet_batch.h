@@ -0,0 +1,68 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PAWNRAKNET_PACKET_BATCH_H_
+#define PAWNRAKNET_PACKET_BATCH_H_
+
+class PacketBatch {
+ public:
+  struct Entry {
+    explicit Entry(Packet *packet)
+        : packet{packet}, bs{packet->data, packet->length, false} {}
+
+    Packet *packet{};
+    unsigned char packet_id{};
+    bool is_player_packet{};
+    bool accepted{true};
+    BitStream bs;
+    cell bs_handle{};  // valid while the batch is being dispatched
+  };
+
+  Entry &Add(Packet *packet);
+
+  Packet *PopPacket();
+
+  bool HasPendingPackets();
+
+  void Clear();
+
+  std::deque<Entry> &GetEntries();
+
+  // Collects entries that are still alive for the script being dispatched
+  std::size_t MakeView();
+
+  Entry *GetViewEntry(std::size_t index);
+
+  std::size_t GetViewSize();
+
+  void ClearView();
+
+ private:
+  std::deque<Entry> entries_;
+  std::size_t next_entry_{};
+
+  std::vector<Entry *> view_;
+};
+
+#endif  // PAWNRAKNET_PACKET_BATCH_H_
@@ -0,0 +1,129 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "main.h"
+
+PacketTap::~PacketTap() { Close(); }
+
+void PacketTap::Open(const std::string &name, std::uint32_t capacity) {
+  Close();
+
+  if (capacity < 4096 || capacity > (1u << 30)) {
+    throw std::runtime_error{"Invalid packet tap size " +
+                             std::to_string(capacity)};
+  }
+
+  std::uint32_t rounded_capacity{4096};
+  while (rounded_capacity < capacity) {
+    rounded_capacity <<= 1;
+  }
+
+  const std::size_t header_size = sizeof(PacketTapHeader);
+  memory_.Create(name, header_size + rounded_capacity);
+
+  const auto mapping = memory_.GetData();
+
+  // readers check the magic, so it is written last
+  header_ = new (mapping) PacketTapHeader{};
+  header_->version = kPacketTapVersion;
+  header_->capacity = rounded_capacity;
+  header_->header_size = static_cast<std::uint32_t>(header_size);
+  std::atomic_thread_fence(std::memory_order_release);
+  header_->magic = kPacketTapMagic;
+
+  data_ = static_cast<unsigned char *>(mapping) + header_size;
+}
+
+void PacketTap::Close() {
+  if (!header_) {
+    return;
+  }
+
+  header_->magic = 0;
+
+  memory_.Close();
+
+  header_ = nullptr;
+  data_ = nullptr;
+}
+
+std::uint32_t PacketTap::GetCapacity() const {
+  return header_ ? header_->capacity : 0;
+}
+
+void PacketTap::Write(PR_EventType type, unsigned char id, int player_id,
+                      const unsigned char *data, unsigned int number_of_bits) {
+  if (!header_) {
+    return;
+  }
+
+  if (!data) {
+    number_of_bits = 0;
+  }
+
+  const std::uint32_t payload_size = BITS_TO_BYTES(number_of_bits);
+  const std::uint32_t size =
+      (sizeof(PacketTapRecord) + payload_size + 7) & ~std::uint32_t{7};
+  const auto capacity = header_->capacity;
+
+  const auto write_pos = header_->write_pos.load(std::memory_order_relaxed);
+  const auto read_pos = header_->read_pos.load(std::memory_order_acquire);
+
+  const auto offset = write_pos & (capacity - 1);
+  const auto skip = capacity - offset < size ? capacity - offset : 0;
+
+  if (size > capacity || capacity - (write_pos - read_pos) < skip + size) {
+    header_->dropped.fetch_add(1, std::memory_order_relaxed);
+
+    return;
+  }
+
+  if (skip >= sizeof(PacketTapRecord)) {
+    auto padding = reinterpret_cast<PacketTapRecord *>(data_ + offset);
+
+    *padding = {};
+    padding->size = skip;
+    padding->type = kPacketTapPaddingType;
+  }
+
+  auto record = reinterpret_cast<PacketTapRecord *>(
+      data_ + ((write_pos + skip) & (capacity - 1)));
+
+  record->size = size;
+  record->type = static_cast<std::uint8_t>(type);
+  record->id = id;
+  record->player_id = player_id < 0 ? kPacketTapNoPlayer
+                                    : static_cast<std::uint16_t>(player_id);
+  record->number_of_bits = number_of_bits;
+  record->reserved = 0;
+  record->time_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now().time_since_epoch())
+                        .count();
+
+  if (payload_size) {
+    memcpy(record + 1, data, payload_size);
+  }
+
+  header_->write_pos.store(write_pos + skip + size, std::memory_order_release);
+}
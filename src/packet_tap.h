@@ -0,0 +1,59 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PAWNRAKNET_PACKET_TAP_H_
+#define PAWNRAKNET_PACKET_TAP_H_
+
+// Copies the traffic seen by the RakServer hooks into a named shared memory
+// ring (see packet_tap_layout.h) for external analytics processes
+class PacketTap {
+ public:
+  ~PacketTap();
+
+  void Open(const std::string &name, std::uint32_t capacity);
+
+  void Close();
+
+  bool IsOpen() const { return header_ != nullptr; }
+
+  const std::string &GetName() const { return memory_.GetName(); }
+
+  std::uint32_t GetCapacity() const;
+
+  void Write(PR_EventType type, unsigned char id, int player_id,
+             const unsigned char *data, unsigned int number_of_bits);
+
+  void Write(PR_EventType type, unsigned char id, int player_id,
+             const BitStream &bs) {
+    Write(type, id, player_id, bs.GetData(), bs.GetNumberOfBitsUsed());
+  }
+
+ private:
+  SharedMemory memory_;
+
+  PacketTapHeader *header_{};
+  unsigned char *data_{};
+};
+
+#endif  // PAWNRAKNET_PACKET_TAP_H_
@@ -0,0 +1,77 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PAWNRAKNET_PACKET_TAP_LAYOUT_H_
+#define PAWNRAKNET_PACKET_TAP_LAYOUT_H_
+
+// Layout of the packet tap shared memory. External readers include this file
+// as it is (see tools/packet_tap_reader), so it only depends on the standard
+// library.
+//
+// The mapping is a PacketTapHeader followed by a data area of `capacity`
+// bytes at offset `header_size`. The data area is a ring of records, each a
+// PacketTapRecord followed by `number_of_bits` of payload and padded to 8
+// bytes. write_pos and read_pos are byte counters that only grow (modulo
+// 2^32); a record starts at pos % capacity. Records never wrap: if one
+// doesn't fit before the end of the area, the writer fills the rest with a
+// record of type kPacketTapPaddingType, or leaves it as is when it is shorter
+// than a PacketTapRecord, and the reader skips it the same way.
+//
+// There is one writer (the server thread) and one reader. The writer never
+// waits for the reader: records that don't fit are counted in `dropped`.
+
+#include <atomic>
+#include <cstdint>
+
+constexpr std::uint32_t kPacketTapMagic = 0x50545250;  // "PRTP"
+constexpr std::uint32_t kPacketTapVersion = 1;
+constexpr std::uint8_t kPacketTapPaddingType = 0xFF;
+constexpr std::uint16_t kPacketTapNoPlayer = 0xFFFF;
+
+struct PacketTapHeader {
+  std::uint32_t magic;
+  std::uint32_t version;
+  std::uint32_t capacity;  // power of two
+  std::uint32_t header_size;
+  std::atomic<std::uint32_t> dropped;
+
+  alignas(64) std::atomic<std::uint32_t> write_pos;  // owned by the writer
+  alignas(64) std::atomic<std::uint32_t> read_pos;   // owned by the reader
+};
+
+struct PacketTapRecord {
+  std::uint32_t size;  // the whole record, padding included
+  std::uint8_t type;   // PR_EventType or kPacketTapPaddingType
+  std::uint8_t id;     // packet or rpc id
+  std::uint16_t player_id;  // kPacketTapNoPlayer for broadcasts
+  std::uint32_t number_of_bits;
+  std::uint32_t reserved;
+  std::uint64_t time_us;  // steady clock of the server machine
+};
+
+static_assert(sizeof(PacketTapRecord) == 24, "PacketTapRecord layout");
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free,
+              "PacketTapHeader positions have to be lock-free");
+
+#endif  // PAWNRAKNET_PACKET_TAP_LAYOUT_H_
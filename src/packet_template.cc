@@ -0,0 +1,69 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "main.h"
+
+PacketTemplate::PacketTemplate(const BitStream &bs)
+    : number_of_bits_{bs.GetNumberOfBitsUsed()},
+      bs_{bs.GetData(), static_cast<unsigned int>(bs.GetNumberOfBytesUsed()),
+          true} {
+  if (!number_of_bits_) {
+    throw std::runtime_error{"Data is empty"};
+  }
+
+  bs_.SetWriteOffset(number_of_bits_);
+}
+
+std::size_t PacketTemplate::AddSlot(int offset, int number_of_bits) {
+  if (number_of_bits <= 0 ||
+      number_of_bits > static_cast<int>(sizeof(cell) * 8)) {
+    throw std::runtime_error{"Invalid number of bits"};
+  }
+
+  if (offset < 0 || offset + number_of_bits > number_of_bits_) {
+    throw std::runtime_error{"Slot doesn't fit into the packet"};
+  }
+
+  slots_.push_back({offset, number_of_bits});
+
+  return slots_.size() - 1;
+}
+
+std::size_t PacketTemplate::GetNumberOfSlots() const { return slots_.size(); }
+
+void PacketTemplate::Apply(const cell *values) {
+  BitStream value_bs;
+
+  for (std::size_t index{}; index < slots_.size(); index++) {
+    const auto &slot = slots_[index];
+
+    value_bs.Reset();
+    value_bs.WriteBits(reinterpret_cast<const unsigned char *>(&values[index]),
+                       slot.number_of_bits, true);
+
+    Script::OverwriteBits(&bs_, slot.offset, value_bs);
+  }
+}
+
+BitStream *PacketTemplate::GetBitStream() { return &bs_; }
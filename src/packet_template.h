@@ -0,0 +1,55 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PAWNRAKNET_PACKET_TEMPLATE_H_
+#define PAWNRAKNET_PACKET_TEMPLATE_H_
+
+// A packet serialized once and sent to many players. Only the slots, bit
+// ranges marked by the script, are rewritten between the recipients
+class PacketTemplate {
+ public:
+  explicit PacketTemplate(const BitStream &bs);
+
+  std::size_t AddSlot(int offset, int number_of_bits);
+
+  std::size_t GetNumberOfSlots() const;
+
+  // Writes one value per slot into the shared buffer
+  void Apply(const cell *values);
+
+  BitStream *GetBitStream();
+
+ private:
+  struct Slot {
+    int offset{};
+    int number_of_bits{};
+  };
+
+  int number_of_bits_{};
+
+  BitStream bs_;
+  std::vector<Slot> slots_;
+};
+
+#endif  // PAWNRAKNET_PACKET_TEMPLATE_H_
@@ -29,16 +29,92 @@ bool Plugin::OnLoad() {
 
   config_->Read();
 
-  StringCompressor::AddReference();
+  ApplyPacketTap();
+  ApplyInjectionChannel();
+
+  string_cache_.SetCapacity(config_->StringCacheSize());
+
+  SetTracing(config_->EnableTracing());
+
+  ApplyLanguageTables();
 
   InstallPreHooks();
 
   RegisterNative<&Script::PR_Init>("PR_Init");
+  RegisterNative<&Script::PR_ReloadConfig>("PR_ReloadConfig");
   RegisterNative<&Script::PR_RegHandler>("PR_RegHandler");
+  RegisterNative<&Script::PR_RegReadOnlyHandler>("PR_RegReadOnlyHandler");
+  RegisterNative<&Script::PR_RegSampledHandler>("PR_RegSampledHandler");
   RegisterNative<&Script::PR_SendPacket>("PR_SendPacket");
   RegisterNative<&Script::PR_SendRPC>("PR_SendRPC");
   RegisterNative<&Script::PR_EmulateIncomingPacket>("PR_EmulateIncomingPacket");
+  RegisterNative<&Script::PR_EmulateIncomingPackets>(
+      "PR_EmulateIncomingPackets");
   RegisterNative<&Script::PR_EmulateIncomingRPC>("PR_EmulateIncomingRPC");
+  RegisterNative<&Script::PR_QueueIncomingRPC>("PR_QueueIncomingRPC");
+  RegisterNative<&Script::PR_SetIncomingRPCTickCap>("PR_SetIncomingRPCTickCap");
+  RegisterNative<&Script::PR_GetInjectionStats>("PR_GetInjectionStats");
+
+  RegisterNative<&Script::PR_StartTrace>("PR_StartTrace");
+  RegisterNative<&Script::PR_StopTrace>("PR_StopTrace");
+  RegisterNative<&Script::PR_FlushTrace>("PR_FlushTrace");
+
+  RegisterNative<&Script::PR_GetLastOnFootSync>("PR_GetLastOnFootSync");
+  RegisterNative<&Script::PR_GetLastInCarSync>("PR_GetLastInCarSync");
+  RegisterNative<&Script::PR_GetLastPassengerSync>("PR_GetLastPassengerSync");
+  RegisterNative<&Script::PR_GetLastAimSync>("PR_GetLastAimSync");
+  RegisterNative<&Script::PR_GetLastBulletSync>("PR_GetLastBulletSync");
+
+  RegisterNative<&Script::PR_SetMovementLimits>("PR_SetMovementLimits");
+  RegisterNative<&Script::PR_GetMovementViolations>(
+      "PR_GetMovementViolations");
+
+  RegisterNative<&Script::PR_SetBulletValidation>("PR_SetBulletValidation");
+  RegisterNative<&Script::PR_SetWeaponRange>("PR_SetWeaponRange");
+  RegisterNative<&Script::PR_GetBulletViolation>("PR_GetBulletViolation");
+  RegisterNative<&Script::PR_GetBulletStats>("PR_GetBulletStats");
+
+  RegisterNative<&Script::PR_StartDemoRecording>("PR_StartDemoRecording");
+  RegisterNative<&Script::PR_StopDemoRecording>("PR_StopDemoRecording");
+  RegisterNative<&Script::PR_PlayDemo>("PR_PlayDemo");
+  RegisterNative<&Script::PR_SeekDemo>("PR_SeekDemo");
+  RegisterNative<&Script::PR_StopDemo>("PR_StopDemo");
+
+  RegisterNative<&Script::PR_StartLoadWalk>("PR_StartLoadWalk");
+  RegisterNative<&Script::PR_StartLoadPath>("PR_StartLoadPath");
+  RegisterNative<&Script::PR_StartLoadReplay>("PR_StartLoadReplay");
+  RegisterNative<&Script::PR_StopLoad>("PR_StopLoad");
+  RegisterNative<&Script::PR_GetLoadStats>("PR_GetLoadStats");
+
+  RegisterNative<&Script::PR_SendMarkersSync>("PR_SendMarkersSync");
+  RegisterNative<&Script::PR_SetMarkerVisible>("PR_SetMarkerVisible");
+  RegisterNative<&Script::PR_GetStringCacheStats>("PR_GetStringCacheStats");
+  RegisterNative<&Script::PR_SetStringLanguage>("PR_SetStringLanguage");
+  RegisterNative<&Script::PR_GetStringLanguage>("PR_GetStringLanguage");
+
+  RegisterNative<&Script::PR_GetPacketBatch>("PR_GetPacketBatch");
+  RegisterNative<&Script::PR_SetPacketBatchResults>(
+      "PR_SetPacketBatchResults");
+
+  RegisterNative<&Script::PR_NewTemplate>("PR_NewTemplate");
+  RegisterNative<&Script::PR_DeleteTemplate>("PR_DeleteTemplate");
+  RegisterNative<&Script::PR_AddTemplateSlot>("PR_AddTemplateSlot");
+  RegisterNative<&Script::PR_SendTemplatePacket>("PR_SendTemplatePacket");
+  RegisterNative<&Script::PR_SendTemplateRPC>("PR_SendTemplateRPC");
+
+  RegisterNative<&Script::PR_GetPlayerBandwidth>("PR_GetPlayerBandwidth");
+  RegisterNative<&Script::PR_GetIdBandwidth>("PR_GetIdBandwidth");
+  RegisterNative<&Script::PR_GetPlayerIdTraffic>("PR_GetPlayerIdTraffic");
+  RegisterNative<&Script::PR_ResetPlayerTraffic>("PR_ResetPlayerTraffic");
+  RegisterNative<&Script::PR_SetBandwidthBudget>("PR_SetBandwidthBudget");
+  RegisterNative<&Script::PR_GetBandwidthBudget>("PR_GetBandwidthBudget");
+  RegisterNative<&Script::PR_GetBudgetStats>("PR_GetBudgetStats");
+
+  RegisterNative<&Script::PR_QueuePacket>("PR_QueuePacket");
+  RegisterNative<&Script::PR_QueueRPC>("PR_QueueRPC");
+  RegisterNative<&Script::PR_SetSendQueueQuota>("PR_SetSendQueueQuota");
+  RegisterNative<&Script::PR_GetSendQueueSize>("PR_GetSendQueueSize");
+  RegisterNative<&Script::PR_ClearSendQueue>("PR_ClearSendQueue");
 
   RegisterNative<&Script::BS_New>("BS_New");
   RegisterNative<&Script::BS_NewCopy>("BS_NewCopy");
@@ -58,6 +134,8 @@ bool Plugin::OnLoad() {
       "BS_GetNumberOfBitsAllocated");
   RegisterNative<&Script::BS_WriteValue, false>("BS_WriteValue");
   RegisterNative<&Script::BS_ReadValue, false>("BS_ReadValue");
+  RegisterNative<&Script::BS_PeekValue, false>("BS_PeekValue");
+  RegisterNative<&Script::BS_PatchValue, false>("BS_PatchValue");
 
   Log("\n\n"
       "    | %s %s | 2016 - %s"
@@ -87,12 +165,57 @@ bool Plugin::LogAmxErrors() { return config_->LogAmxErrors(); }
 void Plugin::OnUnload() {
   config_->Save();
 
-  StringCompressor::RemoveReference();
+  SetTracing(false);
 
   Log("plugin unloaded");
 }
 
-void Plugin::OnProcessTick() { ProcessInternalPackets(); }
+void Plugin::OnProcessTick() {
+  if (config_->WatchConfigFile()) {
+    const auto now = std::chrono::steady_clock::now();
+    if (now - config_checked_at_ >= std::chrono::seconds{1}) {
+      config_checked_at_ = now;
+
+      if (config_->IsModified()) {
+        config_reload_requested_ = true;
+      }
+    }
+  }
+
+  if (config_reload_requested_) {
+    config_reload_requested_ = false;
+
+    ReloadConfig();
+  }
+
+  if (trace_flush_requested_) {
+    trace_flush_requested_ = false;
+
+    try {
+      FlushTrace({});
+    } catch (const std::exception &e) {
+      Log("trace error: %s", e.what());
+    }
+  }
+
+  ProcessInternalPackets();
+
+  if (rakserver_) {
+    send_scheduler_.Process(*rakserver_, bandwidth_monitor_);
+
+    injection_channel_.Process(*rakserver_);
+
+    rpc_emulation_queue_.Process(*rakserver_);
+
+    demo_player_.Process(*rakserver_, bandwidth_monitor_);
+
+    load_generator_.Process();
+  }
+
+  if (movement_validator_.Evaluate()) {
+    OnMovementViolations(movement_validator_.GetViolations().size());
+  }
+}
 
 void Plugin::InstallPreHooks() {
   urmem::sig_scanner scanner;
@@ -126,41 +249,184 @@ void Plugin::InstallPreHooks() {
 void Plugin::InstallRakServerHooks(urmem::address_t addr_rakserver) {
   rakserver_ = std::make_shared<RakServer>(addr_rakserver);
 
-  if (config_->InterceptIncomingPacket()) {
-    rakserver_->InstallHook(RakServer::MethodIndex::kReceive,
-                            &Hooks::RakServer__Receive);
-  }
-
+  // incoming rpcs always go through the fake handlers, so that the
+  // interception can be toggled on reload without re-registering them
   rakserver_->InstallHook(
       RakServer::MethodIndex::kRegisterAsRemoteProcedureCall,
       &Hooks::RakServer__RegisterAsRemoteProcedureCall);
 
-  if (config_->InterceptIncomingRPC()) {
-    Hooks::ReceiveRPC::Init();
+  Hooks::ReceiveRPC::Init();
+
+  // the message handler can't be attached later without racing the RakNet
+  // thread, so it stays attached and checks the config itself
+  if (config_->InterceptIncomingRawPacket() ||
+      config_->InterceptIncomingInternalPacket() ||
+      config_->InterceptOutgoingInternalPacket()) {
+    internal_packet_channel_ = std::make_shared<InternalPacketChannel>();
+
+    message_handler_ = std::make_shared<MessageHandler>();
+
+    rakserver_->AttachPlugin(message_handler_.get());
   }
 
-  if (config_->InterceptOutgoingPacket()) {
+  ApplyRakServerHooks();
+}
+
+void Plugin::ApplyRakServerHooks() {
+  if (!rakserver_) {
+    return;
+  }
+
+  // the tap needs the hooks even when nothing is intercepted
+  const bool tap = packet_tap_.IsOpen();
+
+  // and so do the bullet validation and the demo recording
+  const bool validation =
+      bullet_validator_.GetAction() != PR_BULLET_VALIDATION_OFF;
+  const bool recording = demo_recorder_.IsRecording();
+
+  if (config_->InterceptIncomingPacket() || tap || validation || recording) {
+    rakserver_->InstallHook(RakServer::MethodIndex::kReceive,
+                            &Hooks::RakServer__Receive);
+  } else if (!packet_batch_.HasPendingPackets()) {
+    rakserver_->RemoveHook(RakServer::MethodIndex::kReceive);
+  }
+
+  if (config_->InterceptOutgoingPacket() || tap) {
     rakserver_->InstallHook(RakServer::MethodIndex::kSend,
                             &Hooks::RakServer__Send);
+  } else {
+    rakserver_->RemoveHook(RakServer::MethodIndex::kSend);
   }
 
-  if (config_->InterceptOutgoingRPC()) {
+  if (config_->InterceptOutgoingRPC() || tap) {
     rakserver_->InstallHook(RakServer::MethodIndex::kRPC,
                             &Hooks::RakServer__RPC);
+  } else {
+    rakserver_->RemoveHook(RakServer::MethodIndex::kRPC);
   }
 
-  if (config_->InterceptIncomingRawPacket()) {
-    message_handler_ = std::make_shared<MessageHandler>();
+  if (!message_handler_ && (config_->InterceptIncomingRawPacket() ||
+                            config_->InterceptIncomingInternalPacket() ||
+                            config_->InterceptOutgoingInternalPacket())) {
+    Log("raw and internal packet interception can only be enabled at "
+        "startup, restart the server to apply it");
+  }
+}
 
-    rakserver_->AttachPlugin(message_handler_.get());
+void Plugin::ApplyPacketTap() {
+  const auto &name = config_->PacketTapName();
+
+  if (name.empty()) {
+    if (packet_tap_.IsOpen()) {
+      packet_tap_.Close();
+
+      Log("packet tap closed");
+    }
+
+    return;
   }
 
-  if (config_->InterceptIncomingInternalPacket() ||
-      config_->InterceptOutgoingInternalPacket()) {
-    internal_packet_channel_ = std::make_shared<InternalPacketChannel>();
+  if (packet_tap_.IsOpen() && packet_tap_.GetName() == name &&
+      packet_tap_.GetCapacity() >= config_->PacketTapSize()) {
+    return;
+  }
+
+  try {
+    packet_tap_.Open(name, config_->PacketTapSize());
+
+    Log("packet tap opened: %s, %u bytes", name.c_str(),
+        packet_tap_.GetCapacity());
+  } catch (const std::exception &e) {
+    Log("packet tap error: %s", e.what());
   }
 }
 
+void Plugin::ApplyInjectionChannel() {
+  const auto &name = config_->InjectionChannelName();
+
+  injection_channel_.SetTickLimit(config_->InjectionChannelTickLimit());
+
+  if (name.empty()) {
+    if (injection_channel_.IsOpen()) {
+      injection_channel_.Close();
+
+      Log("injection channel closed");
+    }
+
+    return;
+  }
+
+  if (injection_channel_.IsOpen() && injection_channel_.GetName() == name &&
+      injection_channel_.GetSlotCount() >= config_->InjectionChannelSlots()) {
+    return;
+  }
+
+  try {
+    injection_channel_.Open(name, config_->InjectionChannelSlots());
+
+    Log("injection channel opened: %s, %u slots", name.c_str(),
+        injection_channel_.GetSlotCount());
+  } catch (const std::exception &e) {
+    Log("injection channel error: %s", e.what());
+  }
+}
+
+void Plugin::ApplyLanguageTables() {
+  std::map<int, std::array<unsigned int, 256>> tables;
+
+  const auto &files = config_->LanguageTables();
+
+  for (std::size_t i{}; i < files.size(); i++) {
+    const auto language_id = static_cast<int>(i) + 1;
+
+    try {
+      tables.emplace(language_id, ReadFrequencyTable(files[i]));
+
+      Log("language %d loaded: %s", language_id, files[i].c_str());
+    } catch (const std::exception &e) {
+      Log("language %d error: %s", language_id, e.what());
+    }
+  }
+
+  string_compressor_ = std::make_shared<StringCompressor>(tables);
+
+  // the cached bits of a language are stale once its tree changes
+  string_cache_.Clear();
+}
+
+void Plugin::RequestConfigReload() { config_reload_requested_ = true; }
+
+void Plugin::ReloadConfig() {
+  std::shared_ptr<cpptoml::table> table;
+
+  // the file may be half-written or broken, the server keeps running with
+  // the previous settings until it is fixed
+  try {
+    table = config_->Parse();
+  } catch (const std::exception &e) {
+    config_->Skip();
+
+    Log("config error: %s", e.what());
+
+    return;
+  }
+
+  config_->Read(table);
+
+  ApplyPacketTap();
+  ApplyInjectionChannel();
+  ApplyRakServerHooks();
+
+  ApplyLanguageTables();
+
+  string_cache_.SetCapacity(config_->StringCacheSize());
+
+  SetTracing(config_->EnableTracing());
+
+  Log("config reloaded");
+}
+
 unsigned char Plugin::GetPacketId(Packet *packet) {
   return urmem::call_function<urmem::calling_convention::cdeclcall,
                               unsigned char>(addr_get_packet_id_, packet);
@@ -188,22 +454,28 @@ Packet *Plugin::NewPacket(PlayerIndex index, const BitStream &bs) {
   return p;
 }
 
-void Plugin::PushPacketToEmulate(Packet *packet) {
-  emulating_packets_.push(packet);
-}
+bool Plugin::PushPacketToEmulate(Packet *packet) {
+  if (!emulating_packets_.TryPush(packet)) {
+    free(packet);
 
-Packet *Plugin::GetNextPacketToEmulate() {
-  if (emulating_packets_.empty()) {
-    return nullptr;
+    return false;
   }
 
-  auto packet = emulating_packets_.front();
+  return true;
+}
+
+Packet *Plugin::GetNextPacketToEmulate() {
+  Packet *packet{};
 
-  emulating_packets_.pop();
+  emulating_packets_.TryPop(packet);
 
   return packet;
 }
 
+std::size_t Plugin::GetNumberOfPacketsToEmulate() const {
+  return emulating_packets_.GetSize();
+}
+
 void Plugin::SetOriginalRPCHandler(RPCIndex rpc_id, RPCFunction handler) {
   original_rpc_.at(rpc_id) = handler;
 }
@@ -230,6 +502,10 @@ const std::shared_ptr<urmem::hook> &Plugin::GetHookAmxCleanup() {
 
 const std::shared_ptr<Config> &Plugin::GetConfig() { return config_; }
 
+const std::shared_ptr<BitStreamTable> &Plugin::GetBitStreamTable() {
+  return bitstream_table_;
+}
+
 const std::shared_ptr<RakServer> &Plugin::GetRakServer() { return rakserver_; }
 
 const std::shared_ptr<InternalPacketChannel>
@@ -243,6 +519,8 @@ void Plugin::ProcessInternalPackets() {
     return;
   }
 
+  const Tracer::Span span{tracer_, "ProcessInternalPackets"};
+
   auto internal_packet = ch->TryPopPacket();
   if (!internal_packet) {
     return;
@@ -252,16 +530,214 @@ void Plugin::ProcessInternalPackets() {
   BitStream bs{internal_packet->data,
                BITS_TO_BYTES(internal_packet->dataBitLength), false};
 
+  const auto event_type = ch->IsOutgoingPacket() ? PR_OUTGOING_INTERNAL_PACKET
+                                                 : PR_INCOMING_INTERNAL_PACKET;
+  const auto packet_id = internal_packet->data[0];
+  const auto original_number_of_bits = bs.GetNumberOfBitsUsed();
+
   auto on_event = ch->IsOutgoingPacket() ? OnEvent<PR_OUTGOING_INTERNAL_PACKET>
                                          : OnEvent<PR_INCOMING_INTERNAL_PACKET>;
 
-  bool result = on_event(player_id, internal_packet->data[0], &bs);
+  bool result = on_event(player_id, packet_id, &bs);
 
-  if (internal_packet->data != bs.GetData()) {
-    delete[] internal_packet->data;
+  if (MayModifyStream(event_type, packet_id)) {
+    if (internal_packet->data != bs.GetData()) {
+      delete[] internal_packet->data;
 
-    internal_packet->dataBitLength = bs.CopyData(&internal_packet->data);
+      internal_packet->dataBitLength = bs.CopyData(&internal_packet->data);
+    } else if (bs.GetNumberOfBitsUsed() != original_number_of_bits &&
+               bs.GetNumberOfBitsUsed() > 0) {
+      // overwritten in place, only the length is left to commit
+      internal_packet->dataBitLength = bs.GetNumberOfBitsUsed();
+    }
   }
 
   ch->PushResult(result);
 }
+
+void Plugin::AddPacketBatchConsumer() { packet_batch_consumers_++; }
+
+void Plugin::RemovePacketBatchConsumer() {
+  if (packet_batch_consumers_) {
+    packet_batch_consumers_--;
+  }
+}
+
+bool Plugin::UsePacketBatch() { return packet_batch_consumers_ > 0; }
+
+PacketBatch &Plugin::GetPacketBatch() { return packet_batch_; }
+
+BandwidthMonitor &Plugin::GetBandwidthMonitor() { return bandwidth_monitor_; }
+
+SendScheduler &Plugin::GetSendScheduler() { return send_scheduler_; }
+
+RPCEmulationQueue &Plugin::GetRPCEmulationQueue() {
+  return rpc_emulation_queue_;
+}
+
+PacketTap &Plugin::GetPacketTap() { return packet_tap_; }
+
+InjectionChannel &Plugin::GetInjectionChannel() { return injection_channel_; }
+
+Tracer &Plugin::GetTracer() { return tracer_; }
+
+SyncStore &Plugin::GetSyncStore() { return sync_store_; }
+
+MovementValidator &Plugin::GetMovementValidator() {
+  return movement_validator_;
+}
+
+BulletValidator &Plugin::GetBulletValidator() { return bullet_validator_; }
+
+DemoRecorder &Plugin::GetDemoRecorder() { return demo_recorder_; }
+
+DemoPlayer &Plugin::GetDemoPlayer() { return demo_player_; }
+
+LoadGenerator &Plugin::GetLoadGenerator() { return load_generator_; }
+
+MarkersSync &Plugin::GetMarkersSync() { return markers_sync_; }
+
+StringCache &Plugin::GetStringCache() { return string_cache_; }
+
+const StringCompressor &Plugin::GetStringCompressor() {
+  return *string_compressor_;
+}
+
+void Plugin::SetTracing(bool enabled) {
+  if (enabled) {
+    tracer_.Start();
+  } else {
+    tracer_.Stop();
+  }
+
+#ifndef _WIN32
+  if (enabled && !trace_signal_installed_) {
+    const auto previous =
+        std::signal(SIGUSR2, [](int) { Get().RequestTraceFlush(); });
+    if (previous != SIG_ERR) {
+      previous_trace_signal_handler_ = previous;
+
+      trace_signal_installed_ = true;
+    }
+  } else if (!enabled && trace_signal_installed_) {
+    std::signal(SIGUSR2, previous_trace_signal_handler_);
+
+    trace_signal_installed_ = false;
+  }
+#endif
+}
+
+void Plugin::RequestTraceFlush() { trace_flush_requested_ = true; }
+
+std::size_t Plugin::FlushTrace(const std::string &file_path) {
+  const auto &path = file_path.empty() ? config_->TraceFile() : file_path;
+
+  const auto number = tracer_.Flush(path);
+
+  Log("trace written: %s, %u spans", path.c_str(),
+      static_cast<unsigned int>(number));
+
+  return number;
+}
+
+void Plugin::OnMovementViolations(std::size_t count) {
+  EveryScript([=](const std::shared_ptr<Script> &script) {
+    script->OnMovementViolations(count);
+
+    return true;
+  });
+}
+
+void Plugin::OnPacketBatch(PacketBatch &batch) {
+  auto &table = *Get().GetBitStreamTable();
+
+  for (auto &entry : batch.GetEntries()) {
+    if (entry.is_player_packet) {
+      entry.bs_handle = table.Register(&entry.bs);
+    }
+  }
+
+  EveryScript([&batch](const std::shared_ptr<Script> &script) {
+    script->OnPacketBatch(batch);
+
+    return true;
+  });
+
+  for (auto &entry : batch.GetEntries()) {
+    if (entry.bs_handle) {
+      table.Release(entry.bs_handle);
+
+      entry.bs_handle = 0;
+    }
+  }
+}
+
+void Plugin::AddWritableConsumer(PR_EventType type) {
+  writable_publics_.at(type)++;
+}
+
+void Plugin::AddWritableConsumer(PR_EventType type, unsigned char event_id) {
+  writable_handlers_.at(type).at(event_id)++;
+}
+
+void Plugin::RemoveWritableConsumer(PR_EventType type) {
+  auto &counter = writable_publics_.at(type);
+  if (counter) {
+    counter--;
+  }
+}
+
+void Plugin::RemoveWritableConsumer(PR_EventType type,
+                                    unsigned char event_id) {
+  auto &counter = writable_handlers_.at(type).at(event_id);
+  if (counter) {
+    counter--;
+  }
+}
+
+bool Plugin::MayModifyStream(PR_EventType type, unsigned char event_id) {
+  return writable_publics_[type] || writable_handlers_[type][event_id];
+}
+
+std::array<unsigned int, 256> Plugin::ReadFrequencyTable(
+    const std::string &file) {
+  std::ifstream stream{file};
+  if (!stream) {
+    throw std::runtime_error{"Can't open " + file};
+  }
+
+  std::array<unsigned int, 256> table{};
+  std::uint64_t sum{};
+  std::size_t count{};
+  std::string line;
+
+  while (std::getline(stream, line)) {
+    std::istringstream values{line.substr(0, line.find('#'))};
+
+    std::uint64_t value{};
+    while (values >> value) {
+      if (count == table.size()) {
+        throw std::runtime_error{"More than 256 frequencies in " + file};
+      }
+
+      // the tree counts 0 as 1
+      sum += (std::max)(value, std::uint64_t{1});
+
+      table[count++] = static_cast<unsigned int>(value);
+    }
+
+    if (!values.eof()) {
+      throw std::runtime_error{"Invalid frequency in " + file};
+    }
+  }
+
+  if (count != table.size()) {
+    throw std::runtime_error{"Less than 256 frequencies in " + file};
+  }
+
+  if (sum > (std::numeric_limits<unsigned int>::max)()) {
+    throw std::runtime_error{"Sum of frequencies is too large in " + file};
+  }
+
+  return table;
+}
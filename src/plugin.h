@@ -43,14 +43,35 @@ class Plugin : public ptl::AbstractPlugin<Plugin, Script, NativeParam> {
 
   void InstallRakServerHooks(urmem::address_t addr_rakserver);
 
+  // Installs or removes the RakServer hooks to match the current config
+  void ApplyRakServerHooks();
+
+  // Opens, reopens or closes the packet tap to match the current config
+  void ApplyPacketTap();
+
+  // Opens, reopens or closes the injection channel to match the current
+  // config
+  void ApplyInjectionChannel();
+
+  // Regenerates the PR_CSTRING trees of the languages in LanguageTables
+  void ApplyLanguageTables();
+
+  // The config is re-read at the end of the current server tick
+  void RequestConfigReload();
+
+  void ReloadConfig();
+
   unsigned char GetPacketId(Packet *packet);
 
   Packet *NewPacket(PlayerIndex index, const BitStream &bs);
 
-  void PushPacketToEmulate(Packet *packet);
+  // false if the emulation queue is full, the packet is freed then
+  bool PushPacketToEmulate(Packet *packet);
 
   Packet *GetNextPacketToEmulate();
 
+  std::size_t GetNumberOfPacketsToEmulate() const;
+
   void SetOriginalRPCHandler(RPCIndex rpc_id, RPCFunction handler);
 
   RPCFunction GetOriginalRPCHandler(RPCIndex rpc_id);
@@ -65,16 +86,93 @@ class Plugin : public ptl::AbstractPlugin<Plugin, Script, NativeParam> {
 
   const std::shared_ptr<Config> &GetConfig();
 
+  const std::shared_ptr<BitStreamTable> &GetBitStreamTable();
+
   const std::shared_ptr<RakServer> &GetRakServer();
 
   const std::shared_ptr<InternalPacketChannel> &GetInternalPacketChannel();
 
   void ProcessInternalPackets();
 
+  void AddWritableConsumer(PR_EventType type);
+
+  void AddWritableConsumer(PR_EventType type, unsigned char event_id);
+
+  void RemoveWritableConsumer(PR_EventType type);
+
+  void RemoveWritableConsumer(PR_EventType type, unsigned char event_id);
+
+  // false if only read-only handlers are registered for this event, so the
+  // stream can't have been modified and change detection may be skipped
+  bool MayModifyStream(PR_EventType type, unsigned char event_id);
+
+  void AddPacketBatchConsumer();
+
+  void RemovePacketBatchConsumer();
+
+  bool UsePacketBatch();
+
+  PacketBatch &GetPacketBatch();
+
+  BandwidthMonitor &GetBandwidthMonitor();
+
+  SendScheduler &GetSendScheduler();
+
+  RPCEmulationQueue &GetRPCEmulationQueue();
+
+  PacketTap &GetPacketTap();
+
+  InjectionChannel &GetInjectionChannel();
+
+  Tracer &GetTracer();
+
+  SyncStore &GetSyncStore();
+
+  MovementValidator &GetMovementValidator();
+
+  BulletValidator &GetBulletValidator();
+
+  DemoRecorder &GetDemoRecorder();
+
+  DemoPlayer &GetDemoPlayer();
+
+  LoadGenerator &GetLoadGenerator();
+
+  MarkersSync &GetMarkersSync();
+
+  StringCache &GetStringCache();
+
+  // The reference is valid until the config is reloaded
+  const StringCompressor &GetStringCompressor();
+
+  // Starts or stops the tracer. SIGUSR2 requests a flush only while it runs,
+  // otherwise the signal is left to the server and the other plugins
+  void SetTracing(bool enabled);
+
+  // The trace is written to TraceFile at the end of the current server tick
+  void RequestTraceFlush();
+
+  std::size_t FlushTrace(const std::string &file_path);
+
+  static void OnSendQueueProgress(int player_id, std::size_t remaining) {
+    EveryScript([=](const std::shared_ptr<Script> &script) {
+      script->OnSendQueueProgress(player_id, remaining);
+
+      return true;
+    });
+  }
+
+  static void OnPacketBatch(PacketBatch &batch);
+
+  static void OnMovementViolations(std::size_t count);
+
   template <PR_EventType event_type>
   static bool OnEvent(int player_id, unsigned char event_id, BitStream *bs) {
+    const BitStreamTable::Scope scope{*Get().GetBitStreamTable(), bs};
+    const auto bs_handle = scope.GetHandle();
+
     return EveryScript([=](const std::shared_ptr<Script> &script) {
-      return script->OnEvent<event_type>(player_id, event_id, bs);
+      return script->OnEvent<event_type>(player_id, event_id, bs, bs_handle);
     });
   }
 
@@ -112,8 +210,17 @@ class Plugin : public ptl::AbstractPlugin<Plugin, Script, NativeParam> {
   const char *get_packet_id_mask_ = "?????xxxxxxxxxxxxxxxxx?xxxxxxxxxxxxxxx";
 #endif
 
+  // 256 byte frequencies, as written by tools/string_table_trainer
+  static std::array<unsigned int, 256> ReadFrequencyTable(
+      const std::string &file);
+
   std::shared_ptr<Config> config_;
 
+  std::shared_ptr<BitStreamTable> bitstream_table_{
+      std::make_shared<BitStreamTable>()};
+  bool config_reload_requested_{};
+  std::chrono::steady_clock::time_point config_checked_at_{};
+
   urmem::address_t addr_get_packet_id_{};
 
   std::shared_ptr<RakServer> rakserver_;
@@ -128,7 +235,45 @@ class Plugin : public ptl::AbstractPlugin<Plugin, Script, NativeParam> {
   std::array<RPCFunction, PR_MAX_HANDLERS> original_rpc_{};
   std::array<RPCFunction, PR_MAX_HANDLERS> fake_rpc_{};
 
-  std::queue<Packet *> emulating_packets_;
+  RingBuffer<Packet *> emulating_packets_{16384};
+
+  PacketBatch packet_batch_;
+
+  BandwidthMonitor bandwidth_monitor_;
+  SendScheduler send_scheduler_;
+  RPCEmulationQueue rpc_emulation_queue_;
+  PacketTap packet_tap_;
+  InjectionChannel injection_channel_;
+
+  SyncStore sync_store_;
+  MovementValidator movement_validator_;
+  BulletValidator bullet_validator_;
+
+  DemoRecorder demo_recorder_;
+  DemoPlayer demo_player_;
+
+  LoadGenerator load_generator_;
+
+  MarkersSync markers_sync_;
+
+  StringCache string_cache_;
+
+  // replaced as a whole when the language tables change
+  std::shared_ptr<const StringCompressor> string_compressor_{
+      std::make_shared<StringCompressor>()};
+
+  Tracer tracer_;
+  std::atomic_bool trace_flush_requested_{};
+#ifndef _WIN32
+  bool trace_signal_installed_{};
+  void (*previous_trace_signal_handler_)(int){};
+#endif
+  std::size_t packet_batch_consumers_{};
+
+  std::array<std::size_t, PR_NUMBER_OF_EVENT_TYPES> writable_publics_{};
+  std::array<std::array<std::size_t, PR_MAX_HANDLERS>,
+             PR_NUMBER_OF_EVENT_TYPES>
+      writable_handlers_{};
 };
 
 #endif  // PAWNRAKNET_PLUGIN_H_
@@ -91,7 +91,39 @@ const PlayerID RakServer::GetPlayerIDFromIndex(int index) {
       addr_rakserver_get_player_id_from_index_, addr_rakserver_, index);
 }
 
+void RakServer::RemoveHook(MethodIndex index) {
+  auto &addr = GetMethodAddrFromTable(index);
+
+  urmem::unprotect_scope scope{reinterpret_cast<urmem::address_t>(&addr),
+                               sizeof(urmem::address_t)};
+
+  addr = GetOriginalMethodAddr(index);
+}
+
 urmem::address_t &RakServer::GetMethodAddrFromTable(MethodIndex index) {
   return reinterpret_cast<urmem::address_t *>(
       addr_rakserver_vmt_)[static_cast<std::size_t>(index)];
 }
+
+urmem::address_t RakServer::GetOriginalMethodAddr(MethodIndex index) {
+  switch (index) {
+    case MethodIndex::kSend:
+      return addr_rakserver_send_;
+    case MethodIndex::kRPC:
+      return addr_rakserver_rpc_;
+    case MethodIndex::kReceive:
+      return addr_rakserver_receive_;
+    case MethodIndex::kRegisterAsRemoteProcedureCall:
+      return addr_rakserver_register_as_remote_procedure_call_;
+    case MethodIndex::kDeallocatePacket:
+      return addr_rakserver_deallocate_packet_;
+    case MethodIndex::kAttachPlugin:
+      return addr_rakserver_attach_plugin_;
+    case MethodIndex::kGetIndexFromPlayerID:
+      return addr_rakserver_get_index_from_player_id_;
+    case MethodIndex::kGetPlayerIDFromIndex:
+      return addr_rakserver_get_player_id_from_index_;
+  }
+
+  throw std::runtime_error{"Invalid method index"};
+}
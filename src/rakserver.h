@@ -81,9 +81,14 @@ class RakServer {
     orig_addr = urmem::get_func_addr(handle);
   }
 
+  // Puts the original method back into the table
+  void RemoveHook(MethodIndex index);
+
  private:
   urmem::address_t &GetMethodAddrFromTable(MethodIndex index);
 
+  urmem::address_t GetOriginalMethodAddr(MethodIndex index);
+
   urmem::address_t addr_rakserver_{};
   urmem::address_t addr_rakserver_vmt_{};
 
@@ -0,0 +1,89 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PAWNRAKNET_RING_BUFFER_H_
+#define PAWNRAKNET_RING_BUFFER_H_
+
+// Bounded single-producer/single-consumer queue over a preallocated buffer.
+// Push and pop never allocate or lock
+template <typename T>
+class RingBuffer {
+ public:
+  explicit RingBuffer(std::size_t capacity) {
+    std::size_t size = 1;
+    while (size < capacity) {
+      size <<= 1;
+    }
+
+    items_.resize(size);
+    mask_ = size - 1;
+  }
+
+  bool TryPush(const T &value) {
+    const auto tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) > mask_) {
+      return false;
+    }
+
+    items_[tail & mask_] = value;
+
+    tail_.store(tail + 1, std::memory_order_release);
+
+    return true;
+  }
+
+  bool TryPop(T &value) {
+    const auto head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return false;
+    }
+
+    value = items_[head & mask_];
+
+    head_.store(head + 1, std::memory_order_release);
+
+    return true;
+  }
+
+  bool IsEmpty() const {
+    return head_.load(std::memory_order_acquire) ==
+           tail_.load(std::memory_order_acquire);
+  }
+
+  std::size_t GetSize() const {
+    return tail_.load(std::memory_order_acquire) -
+           head_.load(std::memory_order_acquire);
+  }
+
+  std::size_t GetCapacity() const { return items_.size(); }
+
+ private:
+  std::vector<T> items_;
+  std::size_t mask_{};
+
+  alignas(64) std::atomic<std::size_t> head_{};  // advanced by the consumer
+  alignas(64) std::atomic<std::size_t> tail_{};  // advanced by the producer
+};
+
+#endif  // PAWNRAKNET_RING_BUFFER_H_
@@ -0,0 +1,98 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "main.h"
+
+bool RPCEmulationQueue::Push(RPCIndex rpc_id, const PlayerID &sender,
+                             const BitStream &bs) {
+  if (items_.size() >= kMaxItems) {
+    return false;
+  }
+
+  auto data = AcquireBuffer();
+
+  data.assign(bs.GetData(), bs.GetData() + bs.GetNumberOfBytesUsed());
+
+  items_.push_back({rpc_id, sender, std::move(data), bs.GetNumberOfBitsUsed()});
+
+  return true;
+}
+
+void RPCEmulationQueue::Process(RakServer &rakserver) {
+  // rpcs queued by the handlers themselves wait for the next tick
+  auto count = std::min(items_.size(), tick_cap_);
+
+  for (; count; count--) {
+    auto item = std::move(items_.front());
+
+    items_.pop_front();
+
+    // the player has left since the rpc was queued
+    if (rakserver.GetIndexFromPlayerID(item.sender) == -1) {
+      ReleaseBuffer(std::move(item.data));
+
+      continue;
+    }
+
+    const auto &handler = Plugin::Get().GetOriginalRPCHandler(item.rpc_id);
+
+    RPCParameters rpc_params{};
+
+    rpc_params.numberOfBitsOfData = item.number_of_bits;
+    rpc_params.sender = item.sender;
+    if (rpc_params.numberOfBitsOfData) {
+      rpc_params.input = item.data.data();
+    }
+
+    handler(&rpc_params);
+
+    ReleaseBuffer(std::move(item.data));
+  }
+}
+
+void RPCEmulationQueue::SetTickCap(std::size_t cap) { tick_cap_ = cap; }
+
+std::size_t RPCEmulationQueue::GetSize() const { return items_.size(); }
+
+std::vector<unsigned char> RPCEmulationQueue::AcquireBuffer() {
+  if (buffer_pool_.empty()) {
+    return {};
+  }
+
+  auto buffer = std::move(buffer_pool_.back());
+
+  buffer_pool_.pop_back();
+
+  return buffer;
+}
+
+void RPCEmulationQueue::ReleaseBuffer(std::vector<unsigned char> &&buffer) {
+  if (buffer_pool_.size() >= kMaxPooledBuffers) {
+    return;
+  }
+
+  buffer.clear();
+
+  buffer_pool_.push_back(std::move(buffer));
+}
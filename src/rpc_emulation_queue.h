@@ -0,0 +1,62 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PAWNRAKNET_RPC_EMULATION_QUEUE_H_
+#define PAWNRAKNET_RPC_EMULATION_QUEUE_H_
+
+// Incoming rpcs emulated by scripts, handed to the original server handlers
+// in one go at the next server tick instead of from inside the AMX
+class RPCEmulationQueue {
+ public:
+  // false if the queue is full
+  bool Push(RPCIndex rpc_id, const PlayerID &sender, const BitStream &bs);
+
+  void Process(RakServer &rakserver);
+
+  void SetTickCap(std::size_t cap);
+
+  std::size_t GetSize() const;
+
+ private:
+  static constexpr std::size_t kMaxItems = 16384;
+  static constexpr std::size_t kMaxPooledBuffers = 64;
+
+  struct Item {
+    RPCIndex rpc_id{};
+    PlayerID sender{};
+    std::vector<unsigned char> data;
+    int number_of_bits{};
+  };
+
+  std::vector<unsigned char> AcquireBuffer();
+
+  void ReleaseBuffer(std::vector<unsigned char> &&buffer);
+
+  std::deque<Item> items_;
+  std::vector<std::vector<unsigned char>> buffer_pool_;
+
+  std::size_t tick_cap_{256};
+};
+
+#endif  // PAWNRAKNET_RPC_EMULATION_QUEUE_H_
@@ -24,6 +24,36 @@
 
 #include "main.h"
 
+Script::~Script() {
+  auto &plugin = Plugin::Get();
+
+  for (std::size_t type{}; type < publics_.size(); type++) {
+    if (publics_[type]) {
+      plugin.RemoveWritableConsumer(static_cast<PR_EventType>(type));
+    }
+  }
+
+  if (public_on_packet_batch_) {
+    plugin.RemoveWritableConsumer(PR_INCOMING_PACKET);
+    plugin.RemovePacketBatchConsumer();
+  }
+
+  if (public_on_outcoming_packet_) {
+    plugin.RemoveWritableConsumer(PR_OUTGOING_PACKET);
+  }
+
+  if (public_on_outcoming_rpc_) {
+    plugin.RemoveWritableConsumer(PR_OUTGOING_RPC);
+  }
+
+  handlers_.ForEach([&plugin](PR_EventType type, unsigned char event_id,
+                              const Handler &handler) {
+    if (!handler.read_only) {
+      plugin.RemoveWritableConsumer(type, event_id);
+    }
+  });
+}
+
 // native PR_Init();
 cell Script::PR_Init() {
   InitHandlers();
@@ -31,6 +61,13 @@ cell Script::PR_Init() {
   return 1;
 }
 
+// native PR_ReloadConfig();
+cell Script::PR_ReloadConfig() {
+  Plugin::Get().RequestConfigReload();
+
+  return 1;
+}
+
 // native PR_RegHandler(eventid, const publicname[], PR_EventType:type);
 cell Script::PR_RegHandler(unsigned char event_id, std::string public_name,
                            PR_EventType type) {
@@ -39,6 +76,31 @@ cell Script::PR_RegHandler(unsigned char event_id, std::string public_name,
   return 1;
 }
 
+// native PR_RegReadOnlyHandler(eventid, const publicname[],
+// PR_EventType:type);
+cell Script::PR_RegReadOnlyHandler(unsigned char event_id,
+                                   std::string public_name,
+                                   PR_EventType type) {
+  InitHandler(event_id, public_name, type, true);
+
+  return 1;
+}
+
+// native PR_RegSampledHandler(eventid, const publicname[],
+// PR_EventType:type, interval, min_interval_ms = 0);
+cell Script::PR_RegSampledHandler(unsigned char event_id,
+                                  std::string public_name, PR_EventType type,
+                                  int interval, int min_interval_ms) {
+  if (interval < 1 || min_interval_ms < 0) {
+    throw std::runtime_error{"Invalid sampling interval"};
+  }
+
+  InitHandler(event_id, public_name, type, false,
+              std::make_shared<HandlerSampler>(interval, min_interval_ms));
+
+  return 1;
+}
+
 // native PR_SendPacket(BitStream:bs, playerid, PR_PacketPriority:priority =
 // PR_HIGH_PRIORITY, PR_PacketReliability:reliability = PR_RELIABLE_ORDERED,
 // orderingchannel = 0);
@@ -48,7 +110,14 @@ cell Script::PR_SendPacket(BitStream *bs, int player_id,
                            unsigned char ordering_channel) {
   const bool broadcast = player_id == -1;
 
-  auto &rakserver = Plugin::Get().GetRakServer();
+  auto &plugin = Plugin::Get();
+  auto &rakserver = plugin.GetRakServer();
+
+  if (!plugin.GetBandwidthMonitor().Admit(player_id, PR_OUTGOING_PACKET,
+                                          *bs->GetData(), bs, priority,
+                                          reliability, ordering_channel)) {
+    return 0;
+  }
 
   return rakserver->Send(bs, priority, reliability, ordering_channel,
                          broadcast ? UNASSIGNED_PLAYER_ID
@@ -67,7 +136,14 @@ cell Script::PR_SendRPC(BitStream *bs, int player_id, RPCIndex rpc_id,
                         unsigned char ordering_channel) {
   const bool broadcast = player_id == -1;
 
-  auto &rakserver = Plugin::Get().GetRakServer();
+  auto &plugin = Plugin::Get();
+  auto &rakserver = plugin.GetRakServer();
+
+  if (!plugin.GetBandwidthMonitor().Admit(player_id, PR_OUTGOING_RPC, rpc_id,
+                                          bs, priority, reliability,
+                                          ordering_channel)) {
+    return 0;
+  }
 
   return rakserver->RPC(&rpc_id, bs, priority, reliability, ordering_channel,
                         broadcast ? UNASSIGNED_PLAYER_ID
@@ -81,9 +157,26 @@ cell Script::PR_SendRPC(BitStream *bs, int player_id, RPCIndex rpc_id,
 cell Script::PR_EmulateIncomingPacket(BitStream *bs, int player_id) {
   auto &plugin = Plugin::Get();
 
-  plugin.PushPacketToEmulate(plugin.NewPacket(player_id, *bs));
+  return plugin.PushPacketToEmulate(plugin.NewPacket(player_id, *bs)) ? 1 : 0;
+}
 
-  return 1;
+// native PR_EmulateIncomingPackets(const BitStream:streams[], const
+// players[], count = sizeof streams);
+cell Script::PR_EmulateIncomingPackets(cell *streams, cell *players,
+                                       int count) {
+  auto &plugin = Plugin::Get();
+
+  cell number{};
+
+  for (; number < count; number++) {
+    const auto bs = GetBitStream(streams[number]);
+
+    if (!plugin.PushPacketToEmulate(plugin.NewPacket(players[number], *bs))) {
+      break;
+    }
+  }
+
+  return number;
 }
 
 // native PR_EmulateIncomingRPC(BitStream:bs, playerid, rpcid);
@@ -110,12 +203,623 @@ cell Script::PR_EmulateIncomingRPC(BitStream *bs, int player_id,
   return 1;
 }
 
+// native PR_QueueIncomingRPC(BitStream:bs, playerid, rpcid);
+cell Script::PR_QueueIncomingRPC(BitStream *bs, int player_id,
+                                 RPCIndex rpc_id) {
+  auto &plugin = Plugin::Get();
+  auto &rakserver = plugin.GetRakServer();
+
+  if (!plugin.GetOriginalRPCHandler(rpc_id)) {
+    throw std::runtime_error{"Invalid rpcid"};
+  }
+
+  const auto sender = rakserver->GetPlayerIDFromIndex(player_id);
+  if (sender.binaryAddress == UNASSIGNED_PLAYER_ID.binaryAddress) {
+    throw std::runtime_error{"Invalid player id " + std::to_string(player_id)};
+  }
+
+  return plugin.GetRPCEmulationQueue().Push(rpc_id, sender, *bs) ? 1 : 0;
+}
+
+// native PR_SetIncomingRPCTickCap(cap);
+cell Script::PR_SetIncomingRPCTickCap(int cap) {
+  if (cap <= 0) {
+    throw std::runtime_error{"Invalid cap"};
+  }
+
+  Plugin::Get().GetRPCEmulationQueue().SetTickCap(cap);
+
+  return 1;
+}
+
+// native PR_GetInjectionStats(&processed, &rejected, &throttled = 0);
+cell Script::PR_GetInjectionStats(cell *processed, cell *rejected,
+                                  cell *throttled) {
+  const auto &channel = Plugin::Get().GetInjectionChannel();
+
+  *processed = static_cast<cell>(channel.GetProcessed());
+  *rejected = static_cast<cell>(channel.GetRejected());
+  *throttled = static_cast<cell>(channel.GetThrottled());
+
+  return channel.IsOpen() ? 1 : 0;
+}
+
+// native PR_StartTrace();
+cell Script::PR_StartTrace() {
+  Plugin::Get().SetTracing(true);
+
+  return 1;
+}
+
+// native PR_StopTrace();
+cell Script::PR_StopTrace() {
+  Plugin::Get().SetTracing(false);
+
+  return 1;
+}
+
+// native PR_FlushTrace(const filename[] = "");
+cell Script::PR_FlushTrace(std::string filename) {
+  return static_cast<cell>(Plugin::Get().FlushTrace(filename));
+}
+
+// native PR_GetLastOnFootSync(playerid, data[PR_OnFootSync]);
+cell Script::PR_GetLastOnFootSync(int player_id, cell *data) {
+  auto &plugin = Plugin::Get();
+
+  return plugin.GetSyncStore().GetOnFootSync(
+             player_id, plugin.GetRakServer()->GetPlayerIDFromIndex(player_id),
+             data)
+             ? 1
+             : 0;
+}
+
+// native PR_GetLastInCarSync(playerid, data[PR_InCarSync]);
+cell Script::PR_GetLastInCarSync(int player_id, cell *data) {
+  auto &plugin = Plugin::Get();
+
+  return plugin.GetSyncStore().GetInCarSync(
+             player_id, plugin.GetRakServer()->GetPlayerIDFromIndex(player_id),
+             data)
+             ? 1
+             : 0;
+}
+
+// native PR_GetLastPassengerSync(playerid, data[PR_PassengerSync]);
+cell Script::PR_GetLastPassengerSync(int player_id, cell *data) {
+  auto &plugin = Plugin::Get();
+
+  return plugin.GetSyncStore().GetPassengerSync(
+             player_id, plugin.GetRakServer()->GetPlayerIDFromIndex(player_id),
+             data)
+             ? 1
+             : 0;
+}
+
+// native PR_GetLastAimSync(playerid, data[PR_AimSync]);
+cell Script::PR_GetLastAimSync(int player_id, cell *data) {
+  auto &plugin = Plugin::Get();
+
+  return plugin.GetSyncStore().GetAimSync(
+             player_id, plugin.GetRakServer()->GetPlayerIDFromIndex(player_id),
+             data)
+             ? 1
+             : 0;
+}
+
+// native PR_GetLastBulletSync(playerid, data[PR_BulletSync]);
+cell Script::PR_GetLastBulletSync(int player_id, cell *data) {
+  auto &plugin = Plugin::Get();
+
+  return plugin.GetSyncStore().GetBulletSync(
+             player_id, plugin.GetRakServer()->GetPlayerIDFromIndex(player_id),
+             data)
+             ? 1
+             : 0;
+}
+
+// native PR_SetMovementLimits(Float:max_speed, Float:max_acceleration,
+// Float:max_distance);
+cell Script::PR_SetMovementLimits(float max_speed, float max_acceleration,
+                                  float max_distance) {
+  if (!(max_speed >= 0.0f && max_acceleration >= 0.0f &&
+        max_distance >= 0.0f)) {
+    throw std::runtime_error{"Invalid movement limits"};
+  }
+
+  Plugin::Get().GetMovementValidator().SetLimits(
+      {max_speed, max_acceleration, max_distance});
+
+  return 1;
+}
+
+// native PR_GetMovementViolations(players[], flags[],
+// players_size = sizeof players, flags_size = sizeof flags);
+cell Script::PR_GetMovementViolations(cell *players, cell *flags,
+                                      int players_size, int flags_size) {
+  const auto &violations = Plugin::Get().GetMovementValidator().GetViolations();
+
+  const int size = std::max(std::min(players_size, flags_size), 0);
+
+  const auto count =
+      std::min(violations.size(), static_cast<std::size_t>(size));
+
+  for (std::size_t i{}; i < count; ++i) {
+    players[i] = violations[i].player_id;
+    flags[i] = violations[i].flags;
+  }
+
+  return static_cast<cell>(count);
+}
+
+// native PR_SetBulletValidation(PR_BulletAction:action,
+// lag_window_ms = 250);
+cell Script::PR_SetBulletValidation(PR_BulletAction action,
+                                    int lag_window_ms) {
+  auto &plugin = Plugin::Get();
+  auto &validator = plugin.GetBulletValidator();
+
+  // an invalid call must leave the lag window as it was
+  if (!BulletValidator::IsValidAction(action)) {
+    throw std::runtime_error{"Invalid bullet validation action"};
+  }
+
+  validator.SetLagWindow(std::chrono::milliseconds{lag_window_ms});
+  validator.SetAction(action);
+
+  plugin.ApplyRakServerHooks();
+
+  return 1;
+}
+
+// native PR_SetWeaponRange(weaponid, Float:range);
+cell Script::PR_SetWeaponRange(int weapon_id, float range) {
+  Plugin::Get().GetBulletValidator().SetWeaponRange(weapon_id, range);
+
+  return 1;
+}
+
+// native PR_GetBulletViolation(playerid);
+cell Script::PR_GetBulletViolation(int player_id) {
+  return Plugin::Get().GetBulletValidator().GetLastViolation(player_id);
+}
+
+// native PR_GetBulletStats(playerid, &flagged, &dropped);
+cell Script::PR_GetBulletStats(int player_id, cell *flagged, cell *dropped) {
+  const auto stats = Plugin::Get().GetBulletValidator().GetStats(player_id);
+
+  *flagged = static_cast<cell>(stats.flagged);
+  *dropped = static_cast<cell>(stats.dropped);
+
+  return 1;
+}
+
+// native PR_StartDemoRecording(const filename[]);
+cell Script::PR_StartDemoRecording(std::string filename) {
+  auto &plugin = Plugin::Get();
+
+  plugin.GetDemoRecorder().Start(filename);
+
+  plugin.ApplyRakServerHooks();
+
+  return 1;
+}
+
+// native PR_StopDemoRecording();
+cell Script::PR_StopDemoRecording() {
+  auto &plugin = Plugin::Get();
+
+  const bool result = plugin.GetDemoRecorder().Stop();
+
+  plugin.ApplyRakServerHooks();
+
+  return result ? 1 : 0;
+}
+
+// native PR_PlayDemo(const filename[], const spectators[],
+// count = sizeof spectators, start_ms = 0);
+cell Script::PR_PlayDemo(std::string filename, cell *spectators, int count,
+                         int start_ms) {
+  if (count < 0 || start_ms < 0) {
+    throw std::runtime_error{"Invalid count or start_ms"};
+  }
+
+  return Plugin::Get().GetDemoPlayer().Start(
+      filename, {spectators, spectators + count},
+      static_cast<std::uint32_t>(start_ms));
+}
+
+// native PR_SeekDemo(playbackid, ms);
+cell Script::PR_SeekDemo(int playback_id, int ms) {
+  if (ms < 0) {
+    throw std::runtime_error{"Invalid ms"};
+  }
+
+  return Plugin::Get().GetDemoPlayer().Seek(playback_id,
+                                            static_cast<std::uint32_t>(ms))
+             ? 1
+             : 0;
+}
+
+// native PR_StopDemo(playbackid);
+cell Script::PR_StopDemo(int playback_id) {
+  return Plugin::Get().GetDemoPlayer().Stop(playback_id) ? 1 : 0;
+}
+
+// native PR_StartLoadWalk(playerid, Float:x, Float:y, Float:z,
+// Float:radius, rate = 30, vehicleid = 0);
+cell Script::PR_StartLoadWalk(int player_id, float x, float y, float z,
+                              float radius, int rate, int vehicle_id) {
+  Plugin::Get().GetLoadGenerator().StartWalk(
+      player_id, {x, y, z}, radius, rate,
+      static_cast<std::uint16_t>(vehicle_id));
+
+  return 1;
+}
+
+// native PR_StartLoadPath(playerid, const Float:points[],
+// count = sizeof points, Float:speed = 5.0, rate = 30, vehicleid = 0);
+cell Script::PR_StartLoadPath(int player_id, cell *points, int count,
+                              float speed, int rate, int vehicle_id) {
+  if (count < 0 || count % 3) {
+    throw std::runtime_error{"Invalid count"};
+  }
+
+  std::vector<LoadGenerator::Vector3> path(count / 3);
+
+  for (auto &point : path) {
+    point = {amx_ctof(points[0]), amx_ctof(points[1]), amx_ctof(points[2])};
+
+    points += 3;
+  }
+
+  Plugin::Get().GetLoadGenerator().StartPath(
+      player_id, std::move(path), speed, rate,
+      static_cast<std::uint16_t>(vehicle_id));
+
+  return 1;
+}
+
+// native PR_StartLoadReplay(playerid, const filename[],
+// recorded_playerid);
+cell Script::PR_StartLoadReplay(int player_id, std::string filename,
+                                int recorded_player_id) {
+  Plugin::Get().GetLoadGenerator().StartReplay(player_id, filename,
+                                               recorded_player_id);
+
+  return 1;
+}
+
+// native PR_StopLoad(playerid = -1);
+cell Script::PR_StopLoad(int player_id) {
+  return Plugin::Get().GetLoadGenerator().Stop(player_id) ? 1 : 0;
+}
+
+// native PR_GetLoadStats(&players, &generated, &dropped, &queued,
+// &ticks);
+cell Script::PR_GetLoadStats(cell *players, cell *generated, cell *dropped,
+                             cell *queued, cell *ticks) {
+  auto &plugin = Plugin::Get();
+
+  const auto stats = plugin.GetLoadGenerator().GetStats();
+
+  *players = static_cast<cell>(stats.players);
+  *generated = static_cast<cell>(stats.generated);
+  *dropped = static_cast<cell>(stats.dropped);
+  *queued = static_cast<cell>(plugin.GetNumberOfPacketsToEmulate());
+  *ticks = static_cast<cell>(stats.ticks);
+
+  return 1;
+}
+
+// native PR_SendMarkersSync(Float:radius,
+// PR_PacketPriority:priority = PR_HIGH_PRIORITY,
+// PR_PacketReliability:reliability = PR_UNRELIABLE_SEQUENCED,
+// orderingchannel = 0);
+cell Script::PR_SendMarkersSync(float radius, PR_PacketPriority priority,
+                                PR_PacketReliability reliability,
+                                unsigned char ordering_channel) {
+  auto &plugin = Plugin::Get();
+
+  return plugin.GetMarkersSync().Send(
+      *plugin.GetRakServer(), plugin.GetBandwidthMonitor(),
+      plugin.GetSyncStore(), radius, priority, reliability, ordering_channel);
+}
+
+// native PR_SetMarkerVisible(forplayerid, playerid, bool:visible);
+cell Script::PR_SetMarkerVisible(int for_player_id, int player_id,
+                                 bool visible) {
+  auto &plugin = Plugin::Get();
+
+  plugin.GetMarkersSync().SetVisible(
+      for_player_id, plugin.GetRakServer()->GetPlayerIDFromIndex(for_player_id),
+      player_id, visible);
+
+  return 1;
+}
+
+// native PR_GetStringCacheStats(&hits, &misses, &entries);
+cell Script::PR_GetStringCacheStats(cell *hits, cell *misses, cell *entries) {
+  const auto stats = Plugin::Get().GetStringCache().GetStats();
+
+  *hits = static_cast<cell>(stats.hits);
+  *misses = static_cast<cell>(stats.misses);
+  *entries = static_cast<cell>(stats.entries);
+
+  return 1;
+}
+
+// native PR_SetStringLanguage(languageid = 0);
+cell Script::PR_SetStringLanguage(int language_id) {
+  if (!Plugin::Get().GetStringCompressor().HasTree(language_id)) {
+    throw std::runtime_error{"Invalid language"};
+  }
+
+  string_language_ = language_id;
+
+  return 1;
+}
+
+// native PR_GetStringLanguage();
+cell Script::PR_GetStringLanguage() { return string_language_; }
+
+// native PR_GetPacketBatch(offset, ids[], players[], BitStream:streams[],
+// size = sizeof ids);
+cell Script::PR_GetPacketBatch(int offset, cell *ids, cell *players,
+                               cell *streams, int size) {
+  auto &batch = Plugin::Get().GetPacketBatch();
+
+  if (offset < 0 || size < 0) {
+    throw std::runtime_error{"Invalid offset or size"};
+  }
+
+  int number{};
+
+  for (; number < size; number++) {
+    const auto entry = batch.GetViewEntry(offset + number);
+    if (!entry) {
+      break;
+    }
+
+    ids[number] = entry->packet_id;
+    players[number] = entry->packet->playerIndex;
+    streams[number] = entry->bs_handle;
+  }
+
+  return number;
+}
+
+// native PR_SetPacketBatchResults(offset, const results[], size = sizeof
+// results);
+cell Script::PR_SetPacketBatchResults(int offset, cell *results, int size) {
+  auto &batch = Plugin::Get().GetPacketBatch();
+
+  if (offset < 0 || size < 0) {
+    throw std::runtime_error{"Invalid offset or size"};
+  }
+
+  for (int index{}; index < size; index++) {
+    const auto entry = batch.GetViewEntry(offset + index);
+    if (!entry) {
+      break;
+    }
+
+    if (!results[index]) {
+      entry->accepted = false;
+    }
+  }
+
+  return 1;
+}
+
+// native PacketTemplate:PR_NewTemplate(BitStream:bs);
+cell Script::PR_NewTemplate(BitStream *bs) {
+  auto packet_template = std::make_unique<PacketTemplate>(*bs);
+
+  for (std::size_t index{}; index < packet_templates_.size(); index++) {
+    if (!packet_templates_[index]) {
+      packet_templates_[index] = std::move(packet_template);
+
+      return static_cast<cell>(index + 1);
+    }
+  }
+
+  packet_templates_.push_back(std::move(packet_template));
+
+  return static_cast<cell>(packet_templates_.size());
+}
+
+// native PR_DeleteTemplate(&PacketTemplate:tpl);
+cell Script::PR_DeleteTemplate(cell *template_id) {
+  GetPacketTemplate(*template_id);
+
+  packet_templates_[*template_id - 1].reset();
+
+  *template_id = 0;
+
+  return 1;
+}
+
+// native PR_AddTemplateSlot(PacketTemplate:tpl, offset, number_of_bits);
+cell Script::PR_AddTemplateSlot(int template_id, int offset,
+                                int number_of_bits) {
+  return static_cast<cell>(
+      GetPacketTemplate(template_id).AddSlot(offset, number_of_bits));
+}
+
+// native PR_SendTemplatePacket(PacketTemplate:tpl, const players[], const
+// values[], count = sizeof players, values_size = sizeof values,
+// PR_PacketPriority:priority = PR_HIGH_PRIORITY,
+// PR_PacketReliability:reliability = PR_RELIABLE_ORDERED, orderingchannel =
+// 0);
+cell Script::PR_SendTemplatePacket(int template_id, cell *players,
+                                   cell *values, int count, int values_size,
+                                   PR_PacketPriority priority,
+                                   PR_PacketReliability reliability,
+                                   unsigned char ordering_channel) {
+  return SendPacketTemplate(PR_OUTGOING_PACKET, {}, template_id, players,
+                            values, count, values_size, priority, reliability,
+                            ordering_channel);
+}
+
+// native PR_SendTemplateRPC(PacketTemplate:tpl, rpcid, const players[],
+// const values[], count = sizeof players, values_size = sizeof values,
+// PR_PacketPriority:priority = PR_HIGH_PRIORITY,
+// PR_PacketReliability:reliability = PR_RELIABLE_ORDERED, orderingchannel =
+// 0);
+cell Script::PR_SendTemplateRPC(int template_id, RPCIndex rpc_id,
+                                cell *players, cell *values, int count,
+                                int values_size, PR_PacketPriority priority,
+                                PR_PacketReliability reliability,
+                                unsigned char ordering_channel) {
+  return SendPacketTemplate(PR_OUTGOING_RPC, rpc_id, template_id, players,
+                            values, count, values_size, priority, reliability,
+                            ordering_channel);
+}
+
+// native PR_GetPlayerBandwidth(playerid, &bytes, &packets);
+cell Script::PR_GetPlayerBandwidth(int player_id, cell *bytes, cell *packets) {
+  const auto traffic =
+      Plugin::Get().GetBandwidthMonitor().GetPlayerTraffic(player_id);
+
+  *bytes = static_cast<cell>(traffic.bytes);
+  *packets = static_cast<cell>(traffic.packets);
+
+  return 1;
+}
+
+// native PR_GetIdBandwidth(PR_EventType:type, id, &bytes, &packets);
+cell Script::PR_GetIdBandwidth(PR_EventType type, unsigned char id,
+                               cell *bytes, cell *packets) {
+  const auto traffic =
+      Plugin::Get().GetBandwidthMonitor().GetIdTraffic(type, id);
+
+  *bytes = static_cast<cell>(traffic.bytes);
+  *packets = static_cast<cell>(traffic.packets);
+
+  return 1;
+}
+
+// native PR_GetPlayerIdTraffic(playerid, PR_EventType:type, id, &bytes,
+// &packets);
+cell Script::PR_GetPlayerIdTraffic(int player_id, PR_EventType type,
+                                   unsigned char id, cell *bytes,
+                                   cell *packets) {
+  const auto traffic =
+      Plugin::Get().GetBandwidthMonitor().GetPlayerIdTraffic(player_id, type,
+                                                             id);
+
+  *bytes = static_cast<cell>(traffic.bytes);
+  *packets = static_cast<cell>(traffic.packets);
+
+  return 1;
+}
+
+// native PR_ResetPlayerTraffic(playerid);
+cell Script::PR_ResetPlayerTraffic(int player_id) {
+  Plugin::Get().GetBandwidthMonitor().ResetPlayer(player_id);
+
+  return 1;
+}
+
+// native PR_SetBandwidthBudget(playerid, bytes_per_second,
+// PR_BudgetAction:action = PR_BUDGET_DROP);
+cell Script::PR_SetBandwidthBudget(int player_id, int bytes_per_second,
+                                   PR_BudgetAction action) {
+  if (bytes_per_second < 0) {
+    throw std::runtime_error{"Invalid budget"};
+  }
+
+  Plugin::Get().GetBandwidthMonitor().SetBudget(player_id, bytes_per_second,
+                                                action);
+
+  return 1;
+}
+
+// native PR_GetBandwidthBudget(playerid, &bytes_per_second,
+// &PR_BudgetAction:action);
+cell Script::PR_GetBandwidthBudget(int player_id, cell *bytes_per_second,
+                                   cell *action) {
+  const auto [budget, budget_action] =
+      Plugin::Get().GetBandwidthMonitor().GetBudget(player_id);
+
+  *bytes_per_second = static_cast<cell>(budget);
+  *action = budget_action;
+
+  return 1;
+}
+
+// native PR_GetBudgetStats(playerid, &dropped, &deferred);
+cell Script::PR_GetBudgetStats(int player_id, cell *dropped, cell *deferred) {
+  const auto stats =
+      Plugin::Get().GetBandwidthMonitor().GetBudgetStats(player_id);
+
+  *dropped = static_cast<cell>(stats.dropped);
+  *deferred = static_cast<cell>(stats.deferred);
+
+  return 1;
+}
+
+// native PR_QueuePacket(BitStream:bs, playerid, PR_PacketPriority:priority =
+// PR_HIGH_PRIORITY, PR_PacketReliability:reliability = PR_RELIABLE_ORDERED,
+// orderingchannel = 0);
+cell Script::PR_QueuePacket(BitStream *bs, int player_id,
+                            PR_PacketPriority priority,
+                            PR_PacketReliability reliability,
+                            unsigned char ordering_channel) {
+  return Plugin::Get().GetSendScheduler().Push(
+             player_id, {PR_OUTGOING_PACKET, {}, *bs, priority, reliability,
+                         static_cast<char>(ordering_channel), true})
+             ? 1
+             : 0;
+}
+
+// native PR_QueueRPC(BitStream:bs, playerid, rpcid,
+// PR_PacketPriority:priority = PR_HIGH_PRIORITY,
+// PR_PacketReliability:reliability = PR_RELIABLE_ORDERED, orderingchannel =
+// 0);
+cell Script::PR_QueueRPC(BitStream *bs, int player_id, RPCIndex rpc_id,
+                         PR_PacketPriority priority,
+                         PR_PacketReliability reliability,
+                         unsigned char ordering_channel) {
+  return Plugin::Get().GetSendScheduler().Push(
+             player_id, {PR_OUTGOING_RPC, rpc_id, *bs, priority, reliability,
+                         static_cast<char>(ordering_channel), true})
+             ? 1
+             : 0;
+}
+
+// native PR_SetSendQueueQuota(bytes_per_tick, packets_per_tick);
+cell Script::PR_SetSendQueueQuota(int bytes_per_tick, int packets_per_tick) {
+  if (bytes_per_tick <= 0 || packets_per_tick <= 0) {
+    throw std::runtime_error{"Invalid quota"};
+  }
+
+  Plugin::Get().GetSendScheduler().SetQuota(bytes_per_tick, packets_per_tick);
+
+  return 1;
+}
+
+// native PR_GetSendQueueSize(playerid);
+cell Script::PR_GetSendQueueSize(int player_id) {
+  return static_cast<cell>(
+      Plugin::Get().GetSendScheduler().GetSize(player_id));
+}
+
+// native PR_ClearSendQueue(playerid);
+cell Script::PR_ClearSendQueue(int player_id) {
+  Plugin::Get().GetSendScheduler().Clear(player_id);
+
+  return 1;
+}
+
 // native BitStream:BS_New();
-cell Script::BS_New() { return reinterpret_cast<cell>(bitstream_pool_.New()); }
+cell Script::BS_New() { return bitstream_pool_.New(); }
 
 // native BitStream:BS_NewCopy(BitStream:bs);
 cell Script::BS_NewCopy(BitStream *bs) {
-  const auto bs_copy = bitstream_pool_.New();
+  const auto bs_copy_handle = bitstream_pool_.New();
+  const auto bs_copy = GetBitStream(bs_copy_handle);
 
   int original_read_offset = bs->GetReadOffset();
 
@@ -125,12 +829,14 @@ cell Script::BS_NewCopy(BitStream *bs) {
 
   bs->SetReadOffset(original_read_offset);
 
-  return reinterpret_cast<cell>(bs_copy);
+  return bs_copy_handle;
 }
 
 // native BS_Delete(&BitStream:bs);
 cell Script::BS_Delete(cell *bs) {
-  bitstream_pool_.Delete(GetBitStream(*bs));
+  GetBitStream(*bs);
+
+  bitstream_pool_.Delete(*bs);
 
   *bs = 0;
 
@@ -228,128 +934,7 @@ cell Script::BS_WriteValue(cell *params) {
   const auto bs = GetBitStream(params[1]);
 
   for (std::size_t i = 1; i < (params[0] / sizeof(cell)) - 1; i += 2) {
-    const auto type = *GetPhysAddr(params[i + 1]);
-    const auto &value = *GetPhysAddr(params[i + 2]);
-
-    switch (type) {
-      case PR_STRING:
-      case PR_CSTRING: {
-        auto str = GetString(params[i + 2]);
-
-        if (type == PR_STRING) {
-          bs->Write(str.c_str(), str.size());
-        } else {
-          stringCompressor->EncodeString(str.c_str(), str.size() + 1, bs);
-        }
-
-        break;
-      }
-      case PR_INT8:
-        WriteValue<char>(bs, value);
-        break;
-      case PR_INT16:
-        WriteValue<short>(bs, value);
-        break;
-      case PR_INT32:
-        WriteValue<int>(bs, value);
-        break;
-      case PR_UINT8:
-        WriteValue<unsigned char>(bs, value);
-        break;
-      case PR_UINT16:
-        WriteValue<unsigned short>(bs, value);
-        break;
-      case PR_UINT32:
-        WriteValue<unsigned int>(bs, value);
-        break;
-      case PR_FLOAT:
-        WriteValue<float>(bs, value);
-        break;
-      case PR_BOOL:
-        WriteValue<bool>(bs, value);
-        break;
-      case PR_CINT8:
-        WriteValue<char, true>(bs, value);
-        break;
-      case PR_CINT16:
-        WriteValue<short, true>(bs, value);
-        break;
-      case PR_CINT32:
-        WriteValue<int, true>(bs, value);
-        break;
-      case PR_CUINT8:
-        WriteValue<unsigned char, true>(bs, value);
-        break;
-      case PR_CUINT16:
-        WriteValue<unsigned short, true>(bs, value);
-        break;
-      case PR_CUINT32:
-        WriteValue<unsigned int, true>(bs, value);
-        break;
-      case PR_CFLOAT:
-        WriteValue<float, true>(bs, value);
-        break;
-      case PR_CBOOL:
-        WriteValue<bool, true>(bs, value);
-        break;
-      case PR_BITS: {
-        const auto number_of_bits = *GetPhysAddr(params[i + 3]);
-        if (number_of_bits <= 0 || number_of_bits > (sizeof(cell) * 8)) {
-          throw std::runtime_error{"Invalid number of bits"};
-        }
-
-        bs->WriteBits(reinterpret_cast<const unsigned char *>(&value),
-                      number_of_bits, true);
-
-        i++;
-
-        break;
-      }
-      case PR_FLOAT3:
-      case PR_FLOAT4: {
-        const std::size_t arr_size = (type == PR_FLOAT3 ? 3 : 4);
-        const auto arr = &value;
-
-        for (std::size_t index{}; index < arr_size; index++) {
-          WriteValue<float>(bs, arr[index]);
-        }
-
-        break;
-      }
-      case PR_VECTOR:
-      case PR_NORM_QUAT: {
-        const auto arr = reinterpret_cast<const float *>(&value);
-
-        if (type == PR_VECTOR) {
-          bs->WriteVector(arr[0], arr[1], arr[2]);
-        } else {
-          bs->WriteNormQuat(arr[0], arr[1], arr[2], arr[3]);
-        }
-
-        break;
-      }
-      case PR_STRING8:
-      case PR_STRING32: {
-        auto str = GetString(params[i + 2]);
-
-        if (type == PR_STRING8) {
-          WriteValue<unsigned char>(bs, str.size());
-        } else {
-          WriteValue<unsigned int>(bs, str.size());
-        }
-
-        bs->Write(str.c_str(), str.size());
-
-        break;
-      }
-      case PR_IGNORE_BITS: {
-        bs->SetWriteOffset(bs->GetWriteOffset() + value);
-        break;
-      }
-      default: {
-        throw std::runtime_error{"Invalid type of value"};
-      }
-    }
+    WriteParam(bs, params, i);
   }
 
   return 1;
@@ -362,151 +947,76 @@ cell Script::BS_ReadValue(cell *params) {
   const auto bs = GetBitStream(params[1]);
 
   for (std::size_t i = 1; i < (params[0] / sizeof(cell)) - 1; i += 2) {
-    const auto type = *GetPhysAddr(params[i + 1]);
-    auto &value = *GetPhysAddr(params[i + 2]);
-
-    switch (type) {
-      case PR_STRING:
-      case PR_CSTRING: {
-        const auto size = *GetPhysAddr(params[i + 3]);
-
-        std::unique_ptr<char[]> str{new char[size + 1]{}};
+    ReadParam(bs, params, i);
+  }
 
-        if (type == PR_STRING) {
-          bs->Read(str.get(), size);
-        } else {
-          stringCompressor->DecodeString(str.get(), size, bs);
-        }
+  return 1;
+}
 
-        SetString(&value, str.get(), size + 1);
+// native BS_PeekValue(BitStream:bs, offset, {PR_ValueType, Float, _}:...);
+cell Script::BS_PeekValue(cell *params) {
+  AssertMinParams(4, params);
 
-        i++;
+  const auto bs = GetBitStream(params[1]);
+  const auto offset = params[2];
+  if (offset < 0 || offset > bs->GetNumberOfBitsUsed()) {
+    throw std::runtime_error{"Invalid offset"};
+  }
 
-        break;
-      }
-      case PR_INT8:
-        value = ReadValue<char>(bs);
-        break;
-      case PR_INT16:
-        value = ReadValue<short>(bs);
-        break;
-      case PR_INT32:
-        value = ReadValue<int>(bs);
-        break;
-      case PR_UINT8:
-        value = ReadValue<unsigned char>(bs);
-        break;
-      case PR_UINT16:
-        value = ReadValue<unsigned short>(bs);
-        break;
-      case PR_UINT32:
-        value = ReadValue<unsigned int>(bs);
-        break;
-      case PR_FLOAT:
-        value = ReadValue<float>(bs);
-        break;
-      case PR_BOOL:
-        value = ReadValue<bool>(bs);
-        break;
-      case PR_CINT8:
-        value = ReadValue<char, true>(bs);
-        break;
-      case PR_CINT16:
-        value = ReadValue<short, true>(bs);
-        break;
-      case PR_CINT32:
-        value = ReadValue<int, true>(bs);
-        break;
-      case PR_CUINT8:
-        value = ReadValue<unsigned char, true>(bs);
-        break;
-      case PR_CUINT16:
-        value = ReadValue<unsigned short, true>(bs);
-        break;
-      case PR_CUINT32:
-        value = ReadValue<unsigned int, true>(bs);
-        break;
-      case PR_CFLOAT:
-        value = ReadValue<float, true>(bs);
-        break;
-      case PR_CBOOL:
-        value = ReadValue<bool, true>(bs);
-        break;
-      case PR_BITS: {
-        const auto number_of_bits = *GetPhysAddr(params[i + 3]);
-        if (number_of_bits <= 0 || number_of_bits > (sizeof(cell) * 8)) {
-          throw std::runtime_error{"Invalid number of bits"};
-        }
+  const ReadOffsetScope scope{bs};
 
-        bs->ReadBits(reinterpret_cast<unsigned char *>(&value), number_of_bits,
-                     true);
+  bs->SetReadOffset(offset);
 
-        i++;
+  for (std::size_t i = 2; i < (params[0] / sizeof(cell)) - 1; i += 2) {
+    ReadParam(bs, params, i);
+  }
 
-        break;
-      }
-      case PR_FLOAT3:
-      case PR_FLOAT4: {
-        const std::size_t arr_size = (type == PR_FLOAT3 ? 3 : 4);
-        auto arr = &value;
+  return 1;
+}
 
-        for (std::size_t index{}; index < arr_size; index++) {
-          arr[index] = ReadValue<float>(bs);
-        }
+// native BS_PatchValue(BitStream:bs, offset, {PR_ValueType, Float, _}:...);
+cell Script::BS_PatchValue(cell *params) {
+  AssertMinParams(4, params);
 
-        break;
-      }
-      case PR_VECTOR:
-      case PR_NORM_QUAT: {
-        auto arr = reinterpret_cast<float *>(&value);
-
-        if (type == PR_VECTOR) {
-          bs->ReadVector(arr[0], arr[1], arr[2]);
-        } else {
-          bs->ReadNormQuat(arr[0], arr[1], arr[2], arr[3]);
-        }
+  const auto bs = GetBitStream(params[1]);
+  const int number_of_bits_used = bs->GetNumberOfBitsUsed();
 
-        break;
-      }
-      case PR_STRING8:
-      case PR_STRING32: {
-        const auto max_size = *GetPhysAddr(params[i + 3]) - 1;
+  BitStream value_bs;
 
-        cell size{};
+  // the first pass only checks, so a call that throws leaves the stream as
+  // it was
+  for (const bool patch : {false, true}) {
+    int offset = params[2];
+    if (offset < 0 || offset > number_of_bits_used) {
+      throw std::runtime_error{"Invalid offset"};
+    }
 
-        if (type == PR_STRING8) {
-          size = ReadValue<unsigned char>(bs);
-        } else {
-          size = ReadValue<unsigned int>(bs);
+    for (std::size_t i = 2; i < (params[0] / sizeof(cell)) - 1; i += 2) {
+      if (*GetPhysAddr(params[i + 1]) == PR_IGNORE_BITS) {
+        const cell number_of_bits = *GetPhysAddr(params[i + 2]);
+        if (number_of_bits < -offset ||
+            number_of_bits > number_of_bits_used - offset) {
+          throw std::runtime_error{"Invalid offset"};
         }
 
-        if (size > 0) {
-          if (size > max_size) {
-            Log("%s: Warning! size (%d) > max_size (%d) "
-                "(PR_STRING8/PR_STRING32)",
-                __FUNCTION__, size, max_size);
-
-            size = max_size;
-          }
+        offset += number_of_bits;
 
-          std::unique_ptr<char[]> str{new char[size + 1]{}};
-
-          bs->Read(str.get(), size);
+        continue;
+      }
 
-          SetString(&value, str.get(), size + 1);
-        }
+      value_bs.Reset();
 
-        i++;
+      WriteParam(&value_bs, params, i);
 
-        break;
-      }
-      case PR_IGNORE_BITS: {
-        bs->IgnoreBits(value);
-        break;
+      if (value_bs.GetNumberOfBitsUsed() > number_of_bits_used - offset) {
+        throw std::runtime_error{"Value doesn't fit into the stream"};
       }
-      default: {
-        throw std::runtime_error{"Invalid type of value"};
+
+      if (patch) {
+        OverwriteBits(bs, offset, value_bs);
       }
+
+      offset += value_bs.GetNumberOfBitsUsed();
     }
   }
 
@@ -537,37 +1047,103 @@ bool Script::OnLoad() {
       InitPublic(PR_INCOMING_INTERNAL_PACKET, public_name);
     } else if (public_name == "OnOutgoingInternalPacket") {
       InitPublic(PR_OUTGOING_INTERNAL_PACKET, public_name);
+    } else if (public_name == "OnSendQueueProgress") {
+      public_on_send_queue_progress_ =
+          MakePublic(public_name, config_->UseCaching());
+    } else if (public_name == "OnSendQueueDrained") {
+      public_on_send_queue_drained_ =
+          MakePublic(public_name, config_->UseCaching());
+    } else if (public_name == "OnMovementViolations") {
+      public_on_movement_violations_ =
+          MakePublic(public_name, config_->UseCaching());
+    } else if (public_name == "_pawnraknet_on_packet_batch") {
+      public_on_packet_batch_ = MakePublic(public_name, config_->UseCaching());
+
+      Plugin::Get().AddWritableConsumer(PR_INCOMING_PACKET);
+      Plugin::Get().AddPacketBatchConsumer();
     }
 
     // backward compatibility
     if (public_name == "OnOutcomingPacket") {
       public_on_outcoming_packet_ =
           MakePublic(public_name, config_->UseCaching());
+
+      Plugin::Get().AddWritableConsumer(PR_OUTGOING_PACKET);
     } else if (public_name == "OnOutcomingRPC") {
       public_on_outcoming_rpc_ = MakePublic(public_name, config_->UseCaching());
+
+      Plugin::Get().AddWritableConsumer(PR_OUTGOING_RPC);
     }
   }
 
   return true;
 }
 
-bool Script::ExecPublic(const PublicPtr &pub, int player_id,
-                        unsigned char event_id, BitStream *bs) {
+void Script::OnPacketBatch(PacketBatch &batch) {
+  if (public_on_packet_batch_ && public_on_packet_batch_->Exists()) {
+    const auto count = batch.MakeView();
+    if (count) {
+      public_on_packet_batch_->Exec(static_cast<cell>(count));
+    }
+
+    batch.ClearView();
+  }
+
+  for (auto &entry : batch.GetEntries()) {
+    if (!entry.is_player_packet || !entry.accepted) {
+      continue;
+    }
+
+    entry.accepted =
+        OnEvent<PR_INCOMING_PACKET>(entry.packet->playerIndex, entry.packet_id,
+                                    &entry.bs, entry.bs_handle);
+  }
+}
+
+void Script::OnSendQueueProgress(int player_id, std::size_t remaining) {
+  if (public_on_send_queue_progress_ &&
+      public_on_send_queue_progress_->Exists()) {
+    public_on_send_queue_progress_->Exec(player_id,
+                                         static_cast<cell>(remaining));
+  }
+
+  if (!remaining && public_on_send_queue_drained_ &&
+      public_on_send_queue_drained_->Exists()) {
+    public_on_send_queue_drained_->Exec(player_id);
+  }
+}
+
+void Script::OnMovementViolations(std::size_t count) {
+  if (public_on_movement_violations_ &&
+      public_on_movement_violations_->Exists()) {
+    public_on_movement_violations_->Exec(static_cast<cell>(count));
+  }
+}
+
+bool Script::ExecPublic(const PublicPtr &pub, const char *trace_name,
+                        int player_id, unsigned char event_id, BitStream *bs,
+                        cell bs_handle) {
   if (!pub || !pub->Exists()) {
     return true;
   }
 
+  const Tracer::Span span{GetTracer(), trace_name, event_id, player_id};
+
   bs->ResetReadPointer();
 
-  return pub->Exec(player_id, static_cast<cell>(event_id), bs);
+  return pub->Exec(player_id, static_cast<cell>(event_id), bs_handle);
 }
 
 void Script::InitPublic(PR_EventType type, const std::string &public_name) {
   publics_.at(type) = MakePublic(public_name, config_->UseCaching());
+  public_trace_names_.at(type) = Plugin::Get().GetTracer().Intern(public_name);
+
+  Plugin::Get().AddWritableConsumer(type);
 }
 
 void Script::InitHandler(unsigned char event_id, const std::string &public_name,
-                         PR_EventType type) {
+                         PR_EventType type, bool read_only,
+                         const std::shared_ptr<HandlerSampler> &sampler) {
   auto &plugin = Plugin::Get();
   auto &rakserver = plugin.GetRakServer();
 
@@ -586,7 +1162,13 @@ void Script::InitHandler(unsigned char event_id, const std::string &public_name,
         &event_id, plugin.GetFakeRPCHandler(event_id));
   }
 
-  handlers_.at(type).at(event_id).push_back(pub);
+  const auto trace_name = plugin.GetTracer().Intern(public_name);
+
+  handlers_.Add(type, event_id, {pub, read_only, sampler, trace_name});
+
+  if (!read_only) {
+    plugin.AddWritableConsumer(type, event_id);
+  }
 }
 
 void Script::InitHandlers() {
@@ -597,15 +1179,407 @@ void Script::InitHandlers() {
   }
 }
 
+Tracer &Script::GetTracer() { return Plugin::Get().GetTracer(); }
+
+RakServer &Script::GetRakServer() { return *Plugin::Get().GetRakServer(); }
+
 BitStream *Script::GetBitStream(cell handle) {
-  const auto bs = reinterpret_cast<BitStream *>(handle);
-  if (!bs) {
+  if (!handle) {
     throw std::runtime_error{"Invalid BitStream handle"};
   }
 
+  const auto bs = Plugin::Get().GetBitStreamTable()->Get(handle);
+  if (!bs) {
+    throw std::runtime_error{"BitStream handle " + std::to_string(handle) +
+                             " is no longer valid"};
+  }
+
   return bs;
 }
 
+PacketTemplate &Script::GetPacketTemplate(int template_id) {
+  if (template_id <= 0 ||
+      static_cast<std::size_t>(template_id) > packet_templates_.size() ||
+      !packet_templates_[template_id - 1]) {
+    throw std::runtime_error{"Invalid template handle"};
+  }
+
+  return *packet_templates_[template_id - 1];
+}
+
+cell Script::SendPacketTemplate(PR_EventType type, RPCIndex rpc_id,
+                                int template_id, cell *players, cell *values,
+                                int count, int values_size,
+                                PR_PacketPriority priority,
+                                PR_PacketReliability reliability,
+                                unsigned char ordering_channel) {
+  auto &plugin = Plugin::Get();
+  auto &rakserver = plugin.GetRakServer();
+  auto &packet_template = GetPacketTemplate(template_id);
+
+  const auto number_of_slots = packet_template.GetNumberOfSlots();
+  if (count < 0 ||
+      static_cast<std::size_t>(count) * number_of_slots >
+          static_cast<std::size_t>(values_size)) {
+    throw std::runtime_error{"Not enough values for " + std::to_string(count) +
+                             " players"};
+  }
+
+  const auto bs = packet_template.GetBitStream();
+  const auto event_id = type == PR_OUTGOING_RPC ? rpc_id : *bs->GetData();
+
+  cell number_of_sent{};
+
+  for (int index{}; index < count; index++) {
+    packet_template.Apply(&values[index * number_of_slots]);
+
+    const int player_id = players[index];
+    const bool broadcast = player_id == -1;
+    const auto player =
+        broadcast ? UNASSIGNED_PLAYER_ID
+                  : rakserver->GetPlayerIDFromIndex(player_id);
+
+    if (!plugin.GetBandwidthMonitor().Admit(player_id, type, event_id, bs,
+                                            priority, reliability,
+                                            ordering_channel)) {
+      continue;
+    }
+
+    const bool result =
+        type == PR_OUTGOING_RPC
+            ? rakserver->RPC(&rpc_id, bs, priority, reliability,
+                             ordering_channel, player, broadcast, false)
+            : rakserver->Send(bs, priority, reliability, ordering_channel,
+                              player, broadcast);
+    if (result) {
+      number_of_sent++;
+    }
+  }
+
+  return number_of_sent;
+}
+
+void Script::WriteParam(BitStream *bs, cell *params, std::size_t &i) {
+  const auto type = *GetPhysAddr(params[i + 1]);
+  const auto &value = *GetPhysAddr(params[i + 2]);
+
+  switch (type) {
+    case PR_STRING:
+    case PR_CSTRING: {
+      auto str = GetString(params[i + 2]);
+
+      if (type == PR_STRING) {
+        bs->Write(str.c_str(), str.size());
+      } else {
+        auto &plugin = Plugin::Get();
+
+        const auto &compressor = plugin.GetStringCompressor();
+
+        // the tree may be gone after a config reload
+        if (!compressor.HasTree(string_language_)) {
+          throw std::runtime_error{"Invalid language"};
+        }
+
+        plugin.GetStringCache().Encode(compressor, str, str.size() + 1, *bs,
+                                       string_language_);
+      }
+
+      break;
+    }
+    case PR_INT8:
+      WriteValue<char>(bs, value);
+      break;
+    case PR_INT16:
+      WriteValue<short>(bs, value);
+      break;
+    case PR_INT32:
+      WriteValue<int>(bs, value);
+      break;
+    case PR_UINT8:
+      WriteValue<unsigned char>(bs, value);
+      break;
+    case PR_UINT16:
+      WriteValue<unsigned short>(bs, value);
+      break;
+    case PR_UINT32:
+      WriteValue<unsigned int>(bs, value);
+      break;
+    case PR_FLOAT:
+      WriteValue<float>(bs, value);
+      break;
+    case PR_BOOL:
+      WriteValue<bool>(bs, value);
+      break;
+    case PR_CINT8:
+      WriteValue<char, true>(bs, value);
+      break;
+    case PR_CINT16:
+      WriteValue<short, true>(bs, value);
+      break;
+    case PR_CINT32:
+      WriteValue<int, true>(bs, value);
+      break;
+    case PR_CUINT8:
+      WriteValue<unsigned char, true>(bs, value);
+      break;
+    case PR_CUINT16:
+      WriteValue<unsigned short, true>(bs, value);
+      break;
+    case PR_CUINT32:
+      WriteValue<unsigned int, true>(bs, value);
+      break;
+    case PR_CFLOAT:
+      WriteValue<float, true>(bs, value);
+      break;
+    case PR_CBOOL:
+      WriteValue<bool, true>(bs, value);
+      break;
+    case PR_BITS: {
+      const auto number_of_bits = *GetPhysAddr(params[i + 3]);
+      if (number_of_bits <= 0 ||
+          number_of_bits > static_cast<cell>(sizeof(cell) * 8)) {
+        throw std::runtime_error{"Invalid number of bits"};
+      }
+
+      bs->WriteBits(reinterpret_cast<const unsigned char *>(&value),
+                    number_of_bits, true);
+
+      i++;
+
+      break;
+    }
+    case PR_FLOAT3:
+    case PR_FLOAT4: {
+      const std::size_t arr_size = (type == PR_FLOAT3 ? 3 : 4);
+      const auto arr = &value;
+
+      for (std::size_t index{}; index < arr_size; index++) {
+        WriteValue<float>(bs, arr[index]);
+      }
+
+      break;
+    }
+    case PR_VECTOR:
+    case PR_NORM_QUAT: {
+      const auto arr = reinterpret_cast<const float *>(&value);
+
+      if (type == PR_VECTOR) {
+        bs->WriteVector(arr[0], arr[1], arr[2]);
+      } else {
+        bs->WriteNormQuat(arr[0], arr[1], arr[2], arr[3]);
+      }
+
+      break;
+    }
+    case PR_STRING8:
+    case PR_STRING32: {
+      auto str = GetString(params[i + 2]);
+
+      if (type == PR_STRING8) {
+        WriteValue<unsigned char>(bs, str.size());
+      } else {
+        WriteValue<unsigned int>(bs, str.size());
+      }
+
+      bs->Write(str.c_str(), str.size());
+
+      break;
+    }
+    case PR_IGNORE_BITS: {
+      bs->SetWriteOffset(bs->GetWriteOffset() + value);
+      break;
+    }
+    default: {
+      throw std::runtime_error{"Invalid type of value"};
+    }
+  }
+}
+
+void Script::ReadParam(BitStream *bs, cell *params, std::size_t &i) {
+  const auto type = *GetPhysAddr(params[i + 1]);
+  auto &value = *GetPhysAddr(params[i + 2]);
+
+  switch (type) {
+    case PR_STRING:
+    case PR_CSTRING: {
+      const auto size = *GetPhysAddr(params[i + 3]);
+
+      std::unique_ptr<char[]> str{new char[size + 1]{}};
+
+      if (type == PR_STRING) {
+        bs->Read(str.get(), size);
+      } else {
+        const auto &compressor = Plugin::Get().GetStringCompressor();
+
+        if (!compressor.HasTree(string_language_)) {
+          throw std::runtime_error{"Invalid language"};
+        }
+
+        compressor.DecodeString(str.get(), size, bs, string_language_);
+      }
+
+      SetString(&value, str.get(), size + 1);
+
+      i++;
+
+      break;
+    }
+    case PR_INT8:
+      value = ReadValue<char>(bs);
+      break;
+    case PR_INT16:
+      value = ReadValue<short>(bs);
+      break;
+    case PR_INT32:
+      value = ReadValue<int>(bs);
+      break;
+    case PR_UINT8:
+      value = ReadValue<unsigned char>(bs);
+      break;
+    case PR_UINT16:
+      value = ReadValue<unsigned short>(bs);
+      break;
+    case PR_UINT32:
+      value = ReadValue<unsigned int>(bs);
+      break;
+    case PR_FLOAT:
+      value = ReadValue<float>(bs);
+      break;
+    case PR_BOOL:
+      value = ReadValue<bool>(bs);
+      break;
+    case PR_CINT8:
+      value = ReadValue<char, true>(bs);
+      break;
+    case PR_CINT16:
+      value = ReadValue<short, true>(bs);
+      break;
+    case PR_CINT32:
+      value = ReadValue<int, true>(bs);
+      break;
+    case PR_CUINT8:
+      value = ReadValue<unsigned char, true>(bs);
+      break;
+    case PR_CUINT16:
+      value = ReadValue<unsigned short, true>(bs);
+      break;
+    case PR_CUINT32:
+      value = ReadValue<unsigned int, true>(bs);
+      break;
+    case PR_CFLOAT:
+      value = ReadValue<float, true>(bs);
+      break;
+    case PR_CBOOL:
+      value = ReadValue<bool, true>(bs);
+      break;
+    case PR_BITS: {
+      const auto number_of_bits = *GetPhysAddr(params[i + 3]);
+      if (number_of_bits <= 0 ||
+          number_of_bits > static_cast<cell>(sizeof(cell) * 8)) {
+        throw std::runtime_error{"Invalid number of bits"};
+      }
+
+      bs->ReadBits(reinterpret_cast<unsigned char *>(&value), number_of_bits,
+                   true);
+
+      i++;
+
+      break;
+    }
+    case PR_FLOAT3:
+    case PR_FLOAT4: {
+      const std::size_t arr_size = (type == PR_FLOAT3 ? 3 : 4);
+      auto arr = &value;
+
+      for (std::size_t index{}; index < arr_size; index++) {
+        arr[index] = ReadValue<float>(bs);
+      }
+
+      break;
+    }
+    case PR_VECTOR:
+    case PR_NORM_QUAT: {
+      auto arr = reinterpret_cast<float *>(&value);
+
+      if (type == PR_VECTOR) {
+        bs->ReadVector(arr[0], arr[1], arr[2]);
+      } else {
+        bs->ReadNormQuat(arr[0], arr[1], arr[2], arr[3]);
+      }
+
+      break;
+    }
+    case PR_STRING8:
+    case PR_STRING32: {
+      const auto max_size = *GetPhysAddr(params[i + 3]) - 1;
+
+      cell size{};
+
+      if (type == PR_STRING8) {
+        size = ReadValue<unsigned char>(bs);
+      } else {
+        size = ReadValue<unsigned int>(bs);
+      }
+
+      if (size > 0) {
+        if (size > max_size) {
+          Log("%s: Warning! size (%d) > max_size (%d) "
+              "(PR_STRING8/PR_STRING32)",
+              __FUNCTION__, size, max_size);
+
+          size = max_size;
+        }
+
+        std::unique_ptr<char[]> str{new char[size + 1]{}};
+
+        bs->Read(str.get(), size);
+
+        SetString(&value, str.get(), size + 1);
+      }
+
+      i++;
+
+      break;
+    }
+    case PR_IGNORE_BITS: {
+      bs->IgnoreBits(value);
+      break;
+    }
+    default: {
+      throw std::runtime_error{"Invalid type of value"};
+    }
+  }
+}
+
+void Script::OverwriteBits(BitStream *bs, int offset, const BitStream &src) {
+  const auto dst_data = bs->GetData();
+  const auto src_data = src.GetData();
+  const auto number_of_bits = src.GetNumberOfBitsUsed();
+
+  int bit{};
+
+  if ((offset & 7) == 0) {
+    const auto number_of_bytes = number_of_bits >> 3;
+
+    memcpy(dst_data + (offset >> 3), src_data, number_of_bytes);
+
+    bit = BYTES_TO_BITS(number_of_bytes);
+  }
+
+  // BitStream::WriteBits only appends, so the rest goes bit by bit to keep
+  // the neighbouring fields intact
+  for (; bit < number_of_bits; bit++) {
+    const auto dst_bit = offset + bit;
+    const unsigned char mask = 0x80 >> (dst_bit & 7);
+
+    if (src_data[bit >> 3] & (0x80 >> (bit & 7))) {
+      dst_data[dst_bit >> 3] |= mask;
+    } else {
+      dst_data[dst_bit >> 3] &= ~mask;
+    }
+  }
+}
+
 template <typename T, bool compressed>
 void Script::WriteValue(BitStream *bs, cell value) {
   T prepared_value{};
@@ -25,10 +25,10 @@
 #ifndef PAWNRAKNET_SCRIPT_H_
 #define PAWNRAKNET_SCRIPT_H_
 
-using PublicPtr = std::shared_ptr<ptl::Public>;
-
 class Script : public ptl::AbstractScript<Script> {
  public:
+  ~Script();
+
   const char *VarIsGamemode() { return "_pawnraknet_is_gamemode"; }
 
   const char *VarVersion() { return "_pawnraknet_version"; }
@@ -36,10 +36,24 @@ class Script : public ptl::AbstractScript<Script> {
   // native PR_Init();
   cell PR_Init();
 
+  // native PR_ReloadConfig();
+  cell PR_ReloadConfig();
+
   // native PR_RegHandler(eventid, const publicname[], PR_EventType:type);
   cell PR_RegHandler(unsigned char event_id, std::string public_name,
                      PR_EventType type);
 
+  // native PR_RegReadOnlyHandler(eventid, const publicname[],
+  // PR_EventType:type);
+  cell PR_RegReadOnlyHandler(unsigned char event_id, std::string public_name,
+                             PR_EventType type);
+
+  // native PR_RegSampledHandler(eventid, const publicname[],
+  // PR_EventType:type, interval, min_interval_ms = 0);
+  cell PR_RegSampledHandler(unsigned char event_id, std::string public_name,
+                            PR_EventType type, int interval,
+                            int min_interval_ms);
+
   // native PR_SendPacket(BitStream:bs, playerid, PR_PacketPriority:priority =
   // PR_HIGH_PRIORITY, PR_PacketReliability:reliability = PR_RELIABLE_ORDERED,
   // orderingchannel = 0);
@@ -57,9 +71,223 @@ class Script : public ptl::AbstractScript<Script> {
   // native PR_EmulateIncomingPacket(BitStream:bs, playerid);
   cell PR_EmulateIncomingPacket(BitStream *bs, int player_id);
 
+  // native PR_EmulateIncomingPackets(const BitStream:streams[], const
+  // players[], count = sizeof streams);
+  cell PR_EmulateIncomingPackets(cell *streams, cell *players, int count);
+
   // native PR_EmulateIncomingRPC(BitStream:bs, playerid, rpcid);
   cell PR_EmulateIncomingRPC(BitStream *bs, int player_id, RPCIndex rpc_id);
 
+  // native PR_QueueIncomingRPC(BitStream:bs, playerid, rpcid);
+  cell PR_QueueIncomingRPC(BitStream *bs, int player_id, RPCIndex rpc_id);
+
+  // native PR_SetIncomingRPCTickCap(cap);
+  cell PR_SetIncomingRPCTickCap(int cap);
+
+  // native PR_GetInjectionStats(&processed, &rejected, &throttled = 0);
+  cell PR_GetInjectionStats(cell *processed, cell *rejected,
+                             cell *throttled);
+
+  // native PR_StartTrace();
+  cell PR_StartTrace();
+
+  // native PR_StopTrace();
+  cell PR_StopTrace();
+
+  // native PR_FlushTrace(const filename[] = "");
+  cell PR_FlushTrace(std::string filename);
+
+  // native PR_GetLastOnFootSync(playerid, data[PR_OnFootSync]);
+  cell PR_GetLastOnFootSync(int player_id, cell *data);
+
+  // native PR_GetLastInCarSync(playerid, data[PR_InCarSync]);
+  cell PR_GetLastInCarSync(int player_id, cell *data);
+
+  // native PR_GetLastPassengerSync(playerid, data[PR_PassengerSync]);
+  cell PR_GetLastPassengerSync(int player_id, cell *data);
+
+  // native PR_GetLastAimSync(playerid, data[PR_AimSync]);
+  cell PR_GetLastAimSync(int player_id, cell *data);
+
+  // native PR_GetLastBulletSync(playerid, data[PR_BulletSync]);
+  cell PR_GetLastBulletSync(int player_id, cell *data);
+
+  // native PR_SetMovementLimits(Float:max_speed, Float:max_acceleration,
+  // Float:max_distance);
+  cell PR_SetMovementLimits(float max_speed, float max_acceleration,
+                            float max_distance);
+
+  // native PR_GetMovementViolations(players[], flags[],
+  // players_size = sizeof players, flags_size = sizeof flags);
+  cell PR_GetMovementViolations(cell *players, cell *flags, int players_size,
+                                int flags_size);
+
+  // native PR_SetBulletValidation(PR_BulletAction:action,
+  // lag_window_ms = 250);
+  cell PR_SetBulletValidation(PR_BulletAction action, int lag_window_ms);
+
+  // native PR_SetWeaponRange(weaponid, Float:range);
+  cell PR_SetWeaponRange(int weapon_id, float range);
+
+  // native PR_GetBulletViolation(playerid);
+  cell PR_GetBulletViolation(int player_id);
+
+  // native PR_GetBulletStats(playerid, &flagged, &dropped);
+  cell PR_GetBulletStats(int player_id, cell *flagged, cell *dropped);
+
+  // native PR_StartDemoRecording(const filename[]);
+  cell PR_StartDemoRecording(std::string filename);
+
+  // native PR_StopDemoRecording();
+  cell PR_StopDemoRecording();
+
+  // native PR_PlayDemo(const filename[], const spectators[],
+  // count = sizeof spectators, start_ms = 0);
+  cell PR_PlayDemo(std::string filename, cell *spectators, int count,
+                   int start_ms);
+
+  // native PR_SeekDemo(playbackid, ms);
+  cell PR_SeekDemo(int playback_id, int ms);
+
+  // native PR_StopDemo(playbackid);
+  cell PR_StopDemo(int playback_id);
+
+  // native PR_StartLoadWalk(playerid, Float:x, Float:y, Float:z,
+  // Float:radius, rate = 30, vehicleid = 0);
+  cell PR_StartLoadWalk(int player_id, float x, float y, float z, float radius,
+                        int rate, int vehicle_id);
+
+  // native PR_StartLoadPath(playerid, const Float:points[],
+  // count = sizeof points, Float:speed = 5.0, rate = 30, vehicleid = 0);
+  cell PR_StartLoadPath(int player_id, cell *points, int count, float speed,
+                        int rate, int vehicle_id);
+
+  // native PR_StartLoadReplay(playerid, const filename[],
+  // recorded_playerid);
+  cell PR_StartLoadReplay(int player_id, std::string filename,
+                          int recorded_player_id);
+
+  // native PR_StopLoad(playerid = -1);
+  cell PR_StopLoad(int player_id);
+
+  // native PR_GetLoadStats(&players, &generated, &dropped, &queued,
+  // &ticks);
+  cell PR_GetLoadStats(cell *players, cell *generated, cell *dropped,
+                       cell *queued, cell *ticks);
+
+  // native PR_SendMarkersSync(Float:radius,
+  // PR_PacketPriority:priority = PR_HIGH_PRIORITY,
+  // PR_PacketReliability:reliability = PR_UNRELIABLE_SEQUENCED,
+  // orderingchannel = 0);
+  cell PR_SendMarkersSync(float radius, PR_PacketPriority priority,
+                          PR_PacketReliability reliability,
+                          unsigned char ordering_channel);
+
+  // native PR_SetMarkerVisible(forplayerid, playerid, bool:visible);
+  cell PR_SetMarkerVisible(int for_player_id, int player_id, bool visible);
+
+  // native PR_GetStringCacheStats(&hits, &misses, &entries);
+  cell PR_GetStringCacheStats(cell *hits, cell *misses, cell *entries);
+
+  // native PR_SetStringLanguage(languageid = 0);
+  cell PR_SetStringLanguage(int language_id);
+
+  // native PR_GetStringLanguage();
+  cell PR_GetStringLanguage();
+
+  // native PR_GetPacketBatch(offset, ids[], players[], BitStream:streams[],
+  // size = sizeof ids);
+  cell PR_GetPacketBatch(int offset, cell *ids, cell *players, cell *streams,
+                         int size);
+
+  // native PR_SetPacketBatchResults(offset, const results[], size = sizeof
+  // results);
+  cell PR_SetPacketBatchResults(int offset, cell *results, int size);
+
+  // native PacketTemplate:PR_NewTemplate(BitStream:bs);
+  cell PR_NewTemplate(BitStream *bs);
+
+  // native PR_DeleteTemplate(&PacketTemplate:tpl);
+  cell PR_DeleteTemplate(cell *template_id);
+
+  // native PR_AddTemplateSlot(PacketTemplate:tpl, offset, number_of_bits);
+  cell PR_AddTemplateSlot(int template_id, int offset, int number_of_bits);
+
+  // native PR_SendTemplatePacket(PacketTemplate:tpl, const players[], const
+  // values[], count = sizeof players, values_size = sizeof values,
+  // PR_PacketPriority:priority = PR_HIGH_PRIORITY,
+  // PR_PacketReliability:reliability = PR_RELIABLE_ORDERED, orderingchannel =
+  // 0);
+  cell PR_SendTemplatePacket(int template_id, cell *players, cell *values,
+                             int count, int values_size,
+                             PR_PacketPriority priority,
+                             PR_PacketReliability reliability,
+                             unsigned char ordering_channel);
+
+  // native PR_SendTemplateRPC(PacketTemplate:tpl, rpcid, const players[],
+  // const values[], count = sizeof players, values_size = sizeof values,
+  // PR_PacketPriority:priority = PR_HIGH_PRIORITY,
+  // PR_PacketReliability:reliability = PR_RELIABLE_ORDERED, orderingchannel =
+  // 0);
+  cell PR_SendTemplateRPC(int template_id, RPCIndex rpc_id, cell *players,
+                          cell *values, int count, int values_size,
+                          PR_PacketPriority priority,
+                          PR_PacketReliability reliability,
+                          unsigned char ordering_channel);
+
+  // native PR_GetPlayerBandwidth(playerid, &bytes, &packets);
+  cell PR_GetPlayerBandwidth(int player_id, cell *bytes, cell *packets);
+
+  // native PR_GetIdBandwidth(PR_EventType:type, id, &bytes, &packets);
+  cell PR_GetIdBandwidth(PR_EventType type, unsigned char id, cell *bytes,
+                         cell *packets);
+
+  // native PR_GetPlayerIdTraffic(playerid, PR_EventType:type, id, &bytes,
+  // &packets);
+  cell PR_GetPlayerIdTraffic(int player_id, PR_EventType type,
+                             unsigned char id, cell *bytes, cell *packets);
+
+  // native PR_ResetPlayerTraffic(playerid);
+  cell PR_ResetPlayerTraffic(int player_id);
+
+  // native PR_SetBandwidthBudget(playerid, bytes_per_second,
+  // PR_BudgetAction:action = PR_BUDGET_DROP);
+  cell PR_SetBandwidthBudget(int player_id, int bytes_per_second,
+                             PR_BudgetAction action);
+
+  // native PR_GetBandwidthBudget(playerid, &bytes_per_second,
+  // &PR_BudgetAction:action);
+  cell PR_GetBandwidthBudget(int player_id, cell *bytes_per_second,
+                             cell *action);
+
+  // native PR_GetBudgetStats(playerid, &dropped, &deferred);
+  cell PR_GetBudgetStats(int player_id, cell *dropped, cell *deferred);
+
+  // native PR_QueuePacket(BitStream:bs, playerid, PR_PacketPriority:priority =
+  // PR_HIGH_PRIORITY, PR_PacketReliability:reliability = PR_RELIABLE_ORDERED,
+  // orderingchannel = 0);
+  cell PR_QueuePacket(BitStream *bs, int player_id, PR_PacketPriority priority,
+                      PR_PacketReliability reliability,
+                      unsigned char ordering_channel);
+
+  // native PR_QueueRPC(BitStream:bs, playerid, rpcid,
+  // PR_PacketPriority:priority = PR_HIGH_PRIORITY,
+  // PR_PacketReliability:reliability = PR_RELIABLE_ORDERED, orderingchannel =
+  // 0);
+  cell PR_QueueRPC(BitStream *bs, int player_id, RPCIndex rpc_id,
+                   PR_PacketPriority priority,
+                   PR_PacketReliability reliability,
+                   unsigned char ordering_channel);
+
+  // native PR_SetSendQueueQuota(bytes_per_tick, packets_per_tick);
+  cell PR_SetSendQueueQuota(int bytes_per_tick, int packets_per_tick);
+
+  // native PR_GetSendQueueSize(playerid);
+  cell PR_GetSendQueueSize(int player_id);
+
+  // native PR_ClearSendQueue(playerid);
+  cell PR_ClearSendQueue(int player_id);
+
   // native BitStream:BS_New();
   cell BS_New();
 
@@ -111,31 +339,51 @@ class Script : public ptl::AbstractScript<Script> {
   // native BS_ReadValue(BitStream:bs, {PR_ValueType, Float, _}:...);
   cell BS_ReadValue(cell *params);
 
+  // native BS_PeekValue(BitStream:bs, offset, {PR_ValueType, Float, _}:...);
+  cell BS_PeekValue(cell *params);
+
+  // native BS_PatchValue(BitStream:bs, offset, {PR_ValueType, Float, _}:...);
+  cell BS_PatchValue(cell *params);
+
   bool OnLoad();
 
   template <PR_EventType event_type>
-  bool OnEvent(int player_id, unsigned char event_id, BitStream *bs) {
+  bool OnEvent(int player_id, unsigned char event_id, BitStream *bs,
+               cell bs_handle) {
     if constexpr (event_type == PR_OUTGOING_PACKET) {
-      if (!ExecPublic(public_on_outcoming_packet_, player_id, event_id, bs)) {
+      if (!ExecPublic(public_on_outcoming_packet_, "OnOutcomingPacket",
+                      player_id, event_id, bs, bs_handle)) {
         return false;
       }
     } else if constexpr (event_type == PR_OUTGOING_RPC) {
-      if (!ExecPublic(public_on_outcoming_rpc_, player_id, event_id, bs)) {
+      if (!ExecPublic(public_on_outcoming_rpc_, "OnOutcomingRPC", player_id,
+                      event_id, bs, bs_handle)) {
         return false;
       }
     }
 
     if constexpr (event_type != PR_INCOMING_CUSTOM_RPC) {
-      if (!ExecPublic(std::get<event_type>(publics_), player_id, event_id,
-                      bs)) {
+      if (!ExecPublic(std::get<event_type>(publics_),
+                      std::get<event_type>(public_trace_names_), player_id,
+                      event_id, bs, bs_handle)) {
         return false;
       }
     }
 
-    for (const auto &handler : std::get<event_type>(handlers_).at(event_id)) {
+    HandlerTable::DispatchScope scope{handlers_};
+
+    for (const auto &handler : handlers_.Get(event_type, event_id)) {
+      if (handler.sampler &&
+          !handler.sampler->Pass(GetRakServer(), player_id)) {
+        continue;
+      }
+
+      const Tracer::Span span{GetTracer(), handler.trace_name, event_id,
+                              player_id};
+
       bs->ResetReadPointer();
 
-      if (!handler->Exec(player_id, bs)) {
+      if (!handler.pub->Exec(player_id, bs_handle)) {
         return false;
       }
     }
@@ -143,18 +391,61 @@ class Script : public ptl::AbstractScript<Script> {
     return true;
   }
 
-  bool ExecPublic(const PublicPtr &pub, int player_id, unsigned char event_id,
-                  BitStream *bs);
+  void OnPacketBatch(PacketBatch &batch);
+
+  void OnSendQueueProgress(int player_id, std::size_t remaining);
+
+  void OnMovementViolations(std::size_t count);
+
+  bool ExecPublic(const PublicPtr &pub, const char *trace_name, int player_id,
+                  unsigned char event_id, BitStream *bs, cell bs_handle);
 
   void InitPublic(PR_EventType type, const std::string &public_name);
 
   void InitHandler(unsigned char event_id, const std::string &public_name,
-                   PR_EventType type);
+                   PR_EventType type, bool read_only = false,
+                   const std::shared_ptr<HandlerSampler> &sampler = {});
 
   void InitHandlers();
 
   BitStream *GetBitStream(cell handle);
 
+  static Tracer &GetTracer();
+
+  static RakServer &GetRakServer();
+
+  PacketTemplate &GetPacketTemplate(int template_id);
+
+  // Sends the template once per player, patched with that player's row of
+  // values. Returns the number of successful sends
+  cell SendPacketTemplate(PR_EventType type, RPCIndex rpc_id, int template_id,
+                          cell *players, cell *values, int count,
+                          int values_size, PR_PacketPriority priority,
+                          PR_PacketReliability reliability,
+                          unsigned char ordering_channel);
+
+  // Handle one type/value pair starting at params[i + 1], i is moved past the
+  // extra parameters of the type if it has any
+  void WriteParam(BitStream *bs, cell *params, std::size_t &i);
+
+  void ReadParam(BitStream *bs, cell *params, std::size_t &i);
+
+  // Puts the read offset back where it was, also when a read throws
+  class ReadOffsetScope {
+   public:
+    explicit ReadOffsetScope(BitStream *bs)
+        : bs_{bs}, read_offset_{bs->GetReadOffset()} {}
+
+    ~ReadOffsetScope() { bs_->SetReadOffset(read_offset_); }
+
+   private:
+    BitStream *bs_;
+    int read_offset_;
+  };
+
+  // Overwrites the bits at offset with the contents of src in place
+  static void OverwriteBits(BitStream *bs, int offset, const BitStream &src);
+
   template <typename T, bool compressed = false>
   void WriteValue(BitStream *bs, cell value);
 
@@ -163,22 +454,30 @@ class Script : public ptl::AbstractScript<Script> {
 
  private:
   const std::regex regex_reg_handler_public_name_{
-      R"(^pr_r(?:ip|ir|op|or|irp|iip|oip|icr)_\w+$)"};
+      R"(^pr_r(?:ip|ir|op|or|irp|iip|oip|icr)(?:ro|s)?_\w+$)"};
 
   std::shared_ptr<Config> config_;
 
   std::list<PublicPtr> publics_reg_handler_;
 
   std::array<PublicPtr, PR_NUMBER_OF_EVENT_TYPES> publics_;
-  std::array<std::array<std::list<PublicPtr>, PR_MAX_HANDLERS>,
-             PR_NUMBER_OF_EVENT_TYPES>
-      handlers_;
+  std::array<const char *, PR_NUMBER_OF_EVENT_TYPES> public_trace_names_{};
+  HandlerTable handlers_;
+
+  PublicPtr public_on_packet_batch_;
+  PublicPtr public_on_send_queue_progress_;
+  PublicPtr public_on_send_queue_drained_;
+  PublicPtr public_on_movement_violations_;
 
   // backward compatibility
   PublicPtr public_on_outcoming_packet_;
   PublicPtr public_on_outcoming_rpc_;
 
   BitStreamPool bitstream_pool_;
+
+  std::vector<std::unique_ptr<PacketTemplate>> packet_templates_;
+
+  int string_language_{};  // of PR_CSTRING
 };
 
 #endif  // PAWNRAKNET_SCRIPT_H_
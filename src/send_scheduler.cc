@@ -0,0 +1,149 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "main.h"
+
+bool SendScheduler::Push(int player_id, Item &&item) {
+  if (player_id < 0 || player_id >= PR_MAX_PLAYERS) {
+    throw std::runtime_error{"Invalid player id " + std::to_string(player_id)};
+  }
+
+  if (!item.number_of_bits) {
+    throw std::runtime_error{"Data is empty"};
+  }
+
+  auto &queue = queues_[player_id];
+  if (queue.items.size() >= kMaxItemsPerPlayer) {
+    return false;
+  }
+
+  if (item.notify) {
+    queue.notify_items++;
+  }
+
+  queue.items.push_back(std::move(item));
+
+  return true;
+}
+
+void SendScheduler::Process(RakServer &rakserver, BandwidthMonitor &monitor) {
+  if (queues_.empty()) {
+    return;
+  }
+
+  // the callbacks may queue more, so they are fired once the map is left
+  std::vector<std::pair<int /* player_id */, std::size_t /* remaining */>>
+      progress;
+
+  for (auto it = queues_.begin(); it != queues_.end();) {
+    const auto player_id = it->first;
+    auto &queue = it->second;
+
+    const auto player = rakserver.GetPlayerIDFromIndex(player_id);
+    if (player.binaryAddress == UNASSIGNED_PLAYER_ID.binaryAddress) {
+      it = queues_.erase(it);
+
+      continue;
+    }
+
+    std::uint32_t bytes{};
+    std::uint32_t packets{};
+    bool notify{};
+
+    while (!queue.items.empty() && packets < packets_per_tick_) {
+      auto &item = queue.items.front();
+
+      const auto size = static_cast<std::uint32_t>(item.data.size());
+      if (packets && bytes + size > bytes_per_tick_) {
+        break;
+      }
+
+      if (monitor.IsOverBudget(player_id, item.priority, item.reliability)) {
+        break;
+      }
+
+      BitStream bs{item.data.data(), size, false};
+      bs.SetWriteOffset(item.number_of_bits);
+
+      if (item.type == PR_OUTGOING_RPC) {
+        monitor.Record(player_id, PR_OUTGOING_RPC, item.rpc_id, size);
+
+        rakserver.RPC(&item.rpc_id, &bs, item.priority, item.reliability,
+                      item.ordering_channel, player, false,
+                      item.shift_timestamp);
+      } else {
+        monitor.Record(player_id, PR_OUTGOING_PACKET, item.data[0], size);
+
+        rakserver.Send(&bs, item.priority, item.reliability,
+                       item.ordering_channel, player, false);
+      }
+
+      if (item.notify) {
+        queue.notify_items--;
+
+        notify = true;
+      }
+
+      bytes += size;
+      packets++;
+
+      queue.items.pop_front();
+    }
+
+    if (notify) {
+      progress.emplace_back(player_id, queue.notify_items);
+    }
+
+    if (queue.items.empty()) {
+      it = queues_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  for (const auto &[player_id, remaining] : progress) {
+    Plugin::OnSendQueueProgress(player_id, remaining);
+  }
+}
+
+void SendScheduler::SetQuota(std::uint32_t bytes_per_tick,
+                             std::uint32_t packets_per_tick) {
+  if (!bytes_per_tick || !packets_per_tick) {
+    throw std::runtime_error{"Invalid quota"};
+  }
+
+  bytes_per_tick_ = bytes_per_tick;
+  packets_per_tick_ = packets_per_tick;
+}
+
+std::size_t SendScheduler::GetSize(int player_id) const {
+  const auto it = queues_.find(player_id);
+  if (it == queues_.end()) {
+    return 0;
+  }
+
+  return it->second.items.size();
+}
+
+void SendScheduler::Clear(int player_id) { queues_.erase(player_id); }
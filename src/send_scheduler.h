@@ -0,0 +1,83 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PAWNRAKNET_SEND_SCHEDULER_H_
+#define PAWNRAKNET_SEND_SCHEDULER_H_
+
+// Per-player FIFO queues of outgoing packets and rpcs, drained every server
+// tick within the byte/packet quota, so that bursts reach the player spread
+// over several ticks
+class SendScheduler {
+ public:
+  struct Item {
+    Item(PR_EventType type, RPCIndex rpc_id, const BitStream &bs,
+         int priority, int reliability, char ordering_channel, bool notify,
+         bool shift_timestamp = false)
+        : type{type},
+          rpc_id{rpc_id},
+          data{bs.GetData(), bs.GetData() + bs.GetNumberOfBytesUsed()},
+          number_of_bits{bs.GetNumberOfBitsUsed()},
+          priority{priority},
+          reliability{reliability},
+          ordering_channel{ordering_channel},
+          notify{notify},
+          shift_timestamp{shift_timestamp} {}
+
+    PR_EventType type{};
+    RPCIndex rpc_id{};
+    std::vector<unsigned char> data;
+    int number_of_bits{};
+    int priority{};
+    int reliability{};
+    char ordering_channel{};
+    bool notify{};  // queued by a script, reported through the callbacks
+    bool shift_timestamp{};  // of RakServer::RPC
+  };
+
+  // false if the player's queue is full
+  bool Push(int player_id, Item &&item);
+
+  void Process(RakServer &rakserver, BandwidthMonitor &monitor);
+
+  void SetQuota(std::uint32_t bytes_per_tick, std::uint32_t packets_per_tick);
+
+  std::size_t GetSize(int player_id) const;
+
+  void Clear(int player_id);
+
+ private:
+  static constexpr std::size_t kMaxItemsPerPlayer = 4096;
+
+  struct Queue {
+    std::deque<Item> items;
+    std::size_t notify_items{};
+  };
+
+  std::unordered_map<int, Queue> queues_;
+
+  std::uint32_t bytes_per_tick_{4096};
+  std::uint32_t packets_per_tick_{16};
+};
+
+#endif  // PAWNRAKNET_SEND_SCHEDULER_H_
@@ -0,0 +1,108 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "main.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+SharedMemory::~SharedMemory() { Close(); }
+
+void SharedMemory::Create(const std::string &name, std::size_t size) {
+  Close();
+
+  if (name.empty()) {
+    throw std::runtime_error{"Shared memory name is empty"};
+  }
+
+#ifdef _WIN32
+  const auto handle = CreateFileMappingA(
+      INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0,
+      static_cast<DWORD>(size), ("Local\\" + name).c_str());
+  if (!handle) {
+    throw std::runtime_error{"CreateFileMapping failed with error " +
+                             std::to_string(GetLastError())};
+  }
+
+  const auto data = MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, size);
+  if (!data) {
+    CloseHandle(handle);
+
+    throw std::runtime_error{"MapViewOfFile failed"};
+  }
+
+  handle_ = handle;
+#else
+  const auto shm_name = "/" + name;
+
+  const int fd = shm_open(shm_name.c_str(), O_CREAT | O_RDWR, 0600);
+  if (fd == -1) {
+    throw std::runtime_error{"shm_open failed for " + shm_name};
+  }
+
+  if (ftruncate(fd, size) != 0) {
+    close(fd);
+
+    throw std::runtime_error{"ftruncate failed for " + shm_name};
+  }
+
+  const auto data =
+      mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+  close(fd);
+
+  if (data == MAP_FAILED) {
+    throw std::runtime_error{"mmap failed for " + shm_name};
+  }
+#endif
+
+  name_ = name;
+  data_ = data;
+  size_ = size;
+}
+
+void SharedMemory::Close() {
+  if (!data_) {
+    return;
+  }
+
+#ifdef _WIN32
+  UnmapViewOfFile(data_);
+  CloseHandle(handle_);
+
+  handle_ = nullptr;
+#else
+  munmap(data_, size_);
+  shm_unlink(("/" + name_).c_str());
+#endif
+
+  name_.clear();
+  data_ = nullptr;
+  size_ = 0;
+}
@@ -0,0 +1,60 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PAWNRAKNET_SHARED_MEMORY_H_
+#define PAWNRAKNET_SHARED_MEMORY_H_
+
+// A named memory mapping other processes can open: POSIX shared memory
+// object "/<name>" or the "Local\<name>" file mapping on Windows. The owner
+// removes the name when it is closed.
+class SharedMemory {
+ public:
+  SharedMemory() = default;
+  SharedMemory(const SharedMemory &) = delete;
+  SharedMemory &operator=(const SharedMemory &) = delete;
+
+  ~SharedMemory();
+
+  void Create(const std::string &name, std::size_t size);
+
+  void Close();
+
+  bool IsOpen() const { return data_ != nullptr; }
+
+  const std::string &GetName() const { return name_; }
+
+  void *GetData() const { return data_; }
+
+ private:
+  std::string name_;
+
+  void *data_{};
+  std::size_t size_{};
+
+#ifdef _WIN32
+  void *handle_{};
+#endif
+};
+
+#endif  // PAWNRAKNET_SHARED_MEMORY_H_
@@ -0,0 +1,106 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "main.h"
+
+void StringCache::SetCapacity(std::size_t capacity) {
+  capacity_ = capacity;
+
+  Evict();
+}
+
+void StringCache::Clear() {
+  index_.clear();
+  entries_.clear();
+}
+
+void StringCache::Encode(const StringCompressor &compressor,
+                         const std::string &input, int max_chars_to_write,
+                         BitStream &output, int language_id) {
+  const auto length =
+      max_chars_to_write <= 0 ||
+              input.size() < static_cast<std::size_t>(max_chars_to_write)
+          ? input.size()
+          : static_cast<std::size_t>(max_chars_to_write) - 1;
+
+  if (!capacity_ || length > kMaxLength) {
+    compressor.EncodeString(input.c_str(), max_chars_to_write, &output,
+                            language_id);
+
+    return;
+  }
+
+  const std::string_view text{input.data(), length};
+
+  const auto iter = index_.find({text, language_id});
+  if (iter != index_.end()) {
+    stats_.hits++;
+
+    entries_.splice(entries_.begin(), entries_, iter->second);
+
+    const auto &entry = *iter->second;
+
+    output.WriteBits(entry.data.data(), entry.number_of_bits, false);
+
+    return;
+  }
+
+  stats_.misses++;
+
+  BitStream encoded;
+
+  compressor.EncodeString(input.c_str(), max_chars_to_write, &encoded,
+                          language_id);
+
+  output.WriteBits(encoded.GetData(), encoded.GetNumberOfBitsUsed(), false);
+
+  entries_.push_front({std::string{text}, language_id,
+                       {encoded.GetData(),
+                        encoded.GetData() + encoded.GetNumberOfBytesUsed()},
+                       encoded.GetNumberOfBitsUsed()});
+
+  const auto &entry = entries_.front();
+
+  index_.emplace(Key{entry.text, language_id}, entries_.begin());
+
+  Evict();
+}
+
+StringCache::Stats StringCache::GetStats() const {
+  auto stats = stats_;
+
+  stats.entries = entries_.size();
+
+  return stats;
+}
+
+void StringCache::Evict() {
+  while (entries_.size() > capacity_) {
+    const auto &entry = entries_.back();
+
+    index_.erase({entry.text, entry.language_id});
+
+    entries_.pop_back();
+  }
+}
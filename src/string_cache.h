@@ -0,0 +1,89 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PAWNRAKNET_STRING_CACHE_H_
+#define PAWNRAKNET_STRING_CACHE_H_
+
+// LRU cache of Huffman-encoded strings (PR_CSTRING), so the dialog bodies,
+// textdraws and labels sent to every player are encoded once. An entry
+// holds the exact bits StringCompressor::EncodeString writes and is
+// appended to the output as they are
+class StringCache {
+ public:
+  struct Stats {
+    std::uint64_t hits{};
+    std::uint64_t misses{};
+    std::size_t entries{};
+  };
+
+  // 0 disables the cache
+  void SetCapacity(std::size_t capacity);
+
+  void Clear();
+
+  // Writes the string like StringCompressor::EncodeString. The entries
+  // belong to one compressor, so Clear has to be called when it changes
+  void Encode(const StringCompressor &compressor, const std::string &input,
+              int max_chars_to_write, BitStream &output, int language_id = 0);
+
+  Stats GetStats() const;
+
+ private:
+  // longer strings are encoded every time
+  static constexpr std::size_t kMaxLength = 4096;
+
+  struct Key {
+    std::string_view text;  // points into the entry
+    int language_id{};
+
+    bool operator==(const Key &other) const {
+      return language_id == other.language_id && text == other.text;
+    }
+  };
+
+  struct KeyHash {
+    std::size_t operator()(const Key &key) const {
+      return std::hash<std::string_view>{}(key.text) ^
+             static_cast<std::size_t>(key.language_id);
+    }
+  };
+
+  struct Entry {
+    std::string text;
+    int language_id{};
+    std::vector<unsigned char> data;
+    int number_of_bits{};
+  };
+
+  void Evict();
+
+  std::size_t capacity_{};
+
+  std::list<Entry> entries_;  // most recently used first
+  std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index_;
+
+  Stats stats_;
+};
+
+#endif  // PAWNRAKNET_STRING_CACHE_H_
@@ -0,0 +1,362 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "main.h"
+
+SyncStore::SyncType SyncStore::Update(const Packet &packet) {
+  const int player_id = packet.playerIndex;
+  if (player_id < 0 || player_id >= PR_MAX_PLAYERS || !packet.data ||
+      !packet.length) {
+    return kNumberOfSyncTypes;
+  }
+
+  BitStream bs{packet.data, packet.length, false};
+  bs.SetWriteOffset(packet.bitSize);
+  bs.IgnoreBits(8);
+
+  SyncType type{};
+
+  switch (packet.data[0]) {
+    case kPlayerSyncId: {
+      if (packet.bitSize < kOnFootSyncBits) {
+        return kNumberOfSyncTypes;
+      }
+
+      UpdateOnFoot(player_id, bs);
+
+      type = kOnFoot;
+
+      break;
+    }
+    case kVehicleSyncId: {
+      if (packet.bitSize < kInCarSyncBits) {
+        return kNumberOfSyncTypes;
+      }
+
+      UpdateInCar(player_id, bs);
+
+      type = kInCar;
+
+      break;
+    }
+    case kPassengerSyncId: {
+      if (packet.bitSize < kPassengerSyncBits) {
+        return kNumberOfSyncTypes;
+      }
+
+      UpdatePassenger(player_id, bs);
+
+      type = kPassenger;
+
+      break;
+    }
+    case kAimSyncId: {
+      if (packet.bitSize < kAimSyncBits) {
+        return kNumberOfSyncTypes;
+      }
+
+      UpdateAim(player_id, bs);
+
+      type = kAim;
+
+      break;
+    }
+    case kBulletSyncId: {
+      if (packet.bitSize < kBulletSyncBits) {
+        return kNumberOfSyncTypes;
+      }
+
+      UpdateBullet(player_id, bs);
+
+      type = kBullet;
+
+      break;
+    }
+    default:
+      return kNumberOfSyncTypes;
+  }
+
+  owners_[type][player_id] = packet.playerId;
+
+  if (type == kOnFoot || type == kInCar || type == kPassenger) {
+    position_types_[player_id] = type;
+  }
+
+  return type;
+}
+
+const SyncStore::Vector3 &SyncStore::GetPosition(SyncType type,
+                                                 int player_id) const {
+  switch (type) {
+    case kInCar:
+      return in_car_.position[player_id];
+    case kPassenger:
+      return passenger_.position[player_id];
+    default:
+      return on_foot_.position[player_id];
+  }
+}
+
+const SyncStore::Vector3 &SyncStore::GetVelocity(SyncType type,
+                                                 int player_id) const {
+  return type == kInCar ? in_car_.velocity[player_id]
+                        : on_foot_.velocity[player_id];
+}
+
+bool SyncStore::GetLastPosition(int player_id, const PlayerID &player,
+                                Vector3 &position) const {
+  if (player_id < 0 || player_id >= PR_MAX_PLAYERS) {
+    return false;
+  }
+
+  const auto type = position_types_[player_id];
+  if (!IsOwner(type, player_id, player)) {
+    return false;
+  }
+
+  position = GetPosition(type, player_id);
+
+  return true;
+}
+
+const SyncStore::OnFoot &SyncStore::GetOnFoot() const { return on_foot_; }
+
+const SyncStore::InCar &SyncStore::GetInCar() const { return in_car_; }
+
+bool SyncStore::GetOnFootSync(int player_id, const PlayerID &player,
+                              cell *data) const {
+  if (!IsOwner(kOnFoot, player_id, player)) {
+    return false;
+  }
+
+  const auto &s = on_foot_;
+
+  Put(data, s.lr_key[player_id]);
+  Put(data, s.ud_key[player_id]);
+  Put(data, s.keys[player_id]);
+  Put(data, s.position[player_id]);
+  Put(data, s.quaternion[player_id]);
+  Put(data, s.health[player_id]);
+  Put(data, s.armour[player_id]);
+  Put(data, s.weapon_id[player_id]);
+  Put(data, s.additional_key[player_id]);
+  Put(data, s.special_action[player_id]);
+  Put(data, s.velocity[player_id]);
+  Put(data, s.surfing_offsets[player_id]);
+  Put(data, s.surfing_vehicle_id[player_id]);
+  Put(data, s.animation_id[player_id]);
+  Put(data, s.animation_flags[player_id]);
+
+  return true;
+}
+
+bool SyncStore::GetInCarSync(int player_id, const PlayerID &player,
+                             cell *data) const {
+  if (!IsOwner(kInCar, player_id, player)) {
+    return false;
+  }
+
+  const auto &s = in_car_;
+
+  Put(data, s.vehicle_id[player_id]);
+  Put(data, s.lr_key[player_id]);
+  Put(data, s.ud_key[player_id]);
+  Put(data, s.keys[player_id]);
+  Put(data, s.quaternion[player_id]);
+  Put(data, s.position[player_id]);
+  Put(data, s.velocity[player_id]);
+  Put(data, s.vehicle_health[player_id]);
+  Put(data, s.player_health[player_id]);
+  Put(data, s.armour[player_id]);
+  Put(data, s.weapon_id[player_id]);
+  Put(data, s.additional_key[player_id]);
+  Put(data, s.siren_state[player_id]);
+  Put(data, s.landing_gear_state[player_id]);
+  Put(data, s.trailer_id[player_id]);
+  Put(data, s.train_speed[player_id]);
+
+  return true;
+}
+
+bool SyncStore::GetPassengerSync(int player_id, const PlayerID &player,
+                                 cell *data) const {
+  if (!IsOwner(kPassenger, player_id, player)) {
+    return false;
+  }
+
+  const auto &s = passenger_;
+
+  Put(data, s.vehicle_id[player_id]);
+  Put(data, s.seat_id[player_id]);
+  Put(data, s.drive_by[player_id]);
+  Put(data, s.weapon_id[player_id]);
+  Put(data, s.additional_key[player_id]);
+  Put(data, s.player_health[player_id]);
+  Put(data, s.player_armour[player_id]);
+  Put(data, s.lr_key[player_id]);
+  Put(data, s.ud_key[player_id]);
+  Put(data, s.keys[player_id]);
+  Put(data, s.position[player_id]);
+
+  return true;
+}
+
+bool SyncStore::GetAimSync(int player_id, const PlayerID &player,
+                           cell *data) const {
+  if (!IsOwner(kAim, player_id, player)) {
+    return false;
+  }
+
+  const auto &s = aim_;
+
+  Put(data, s.cam_mode[player_id]);
+  Put(data, s.cam_front_vec[player_id]);
+  Put(data, s.cam_pos[player_id]);
+  Put(data, s.aim_z[player_id]);
+  Put(data, s.cam_zoom[player_id]);
+  Put(data, s.weapon_state[player_id]);
+  Put(data, s.aspect_ratio[player_id]);
+
+  return true;
+}
+
+bool SyncStore::GetBulletSync(int player_id, const PlayerID &player,
+                              cell *data) const {
+  if (!IsOwner(kBullet, player_id, player)) {
+    return false;
+  }
+
+  const auto &s = bullet_;
+
+  Put(data, s.hit_type[player_id]);
+  Put(data, s.hit_id[player_id]);
+  Put(data, s.origin[player_id]);
+  Put(data, s.hit_pos[player_id]);
+  Put(data, s.offsets[player_id]);
+  Put(data, s.weapon_id[player_id]);
+
+  return true;
+}
+
+void SyncStore::UpdateOnFoot(int player_id, BitStream &bs) {
+  auto &s = on_foot_;
+
+  Read(bs, s.lr_key[player_id]);
+  Read(bs, s.ud_key[player_id]);
+  Read(bs, s.keys[player_id]);
+  Read(bs, s.position[player_id]);
+  Read(bs, s.quaternion[player_id]);
+  Read(bs, s.health[player_id]);
+  Read(bs, s.armour[player_id]);
+  ReadBits(bs, s.additional_key[player_id], 2);
+  ReadBits(bs, s.weapon_id[player_id], 6);
+  Read(bs, s.special_action[player_id]);
+  Read(bs, s.velocity[player_id]);
+  Read(bs, s.surfing_offsets[player_id]);
+  Read(bs, s.surfing_vehicle_id[player_id]);
+  Read(bs, s.animation_id[player_id]);
+  Read(bs, s.animation_flags[player_id]);
+}
+
+void SyncStore::UpdateInCar(int player_id, BitStream &bs) {
+  auto &s = in_car_;
+
+  Read(bs, s.vehicle_id[player_id]);
+  Read(bs, s.lr_key[player_id]);
+  Read(bs, s.ud_key[player_id]);
+  Read(bs, s.keys[player_id]);
+  Read(bs, s.quaternion[player_id]);
+  Read(bs, s.position[player_id]);
+  Read(bs, s.velocity[player_id]);
+  Read(bs, s.vehicle_health[player_id]);
+  Read(bs, s.player_health[player_id]);
+  Read(bs, s.armour[player_id]);
+  ReadBits(bs, s.additional_key[player_id], 2);
+  ReadBits(bs, s.weapon_id[player_id], 6);
+  Read(bs, s.siren_state[player_id]);
+  Read(bs, s.landing_gear_state[player_id]);
+  Read(bs, s.trailer_id[player_id]);
+  Read(bs, s.train_speed[player_id]);
+}
+
+void SyncStore::UpdatePassenger(int player_id, BitStream &bs) {
+  auto &s = passenger_;
+
+  Read(bs, s.vehicle_id[player_id]);
+  ReadBits(bs, s.drive_by[player_id], 2);
+  ReadBits(bs, s.seat_id[player_id], 6);
+  ReadBits(bs, s.additional_key[player_id], 2);
+  ReadBits(bs, s.weapon_id[player_id], 6);
+  Read(bs, s.player_health[player_id]);
+  Read(bs, s.player_armour[player_id]);
+  Read(bs, s.lr_key[player_id]);
+  Read(bs, s.ud_key[player_id]);
+  Read(bs, s.keys[player_id]);
+  Read(bs, s.position[player_id]);
+}
+
+void SyncStore::UpdateAim(int player_id, BitStream &bs) {
+  auto &s = aim_;
+
+  Read(bs, s.cam_mode[player_id]);
+  Read(bs, s.cam_front_vec[player_id]);
+  Read(bs, s.cam_pos[player_id]);
+  Read(bs, s.aim_z[player_id]);
+  ReadBits(bs, s.weapon_state[player_id], 2);
+  ReadBits(bs, s.cam_zoom[player_id], 6);
+  Read(bs, s.aspect_ratio[player_id]);
+}
+
+void SyncStore::UpdateBullet(int player_id, BitStream &bs) {
+  auto &s = bullet_;
+
+  Read(bs, s.hit_type[player_id]);
+  Read(bs, s.hit_id[player_id]);
+  Read(bs, s.origin[player_id]);
+  Read(bs, s.hit_pos[player_id]);
+  Read(bs, s.offsets[player_id]);
+  Read(bs, s.weapon_id[player_id]);
+}
+
+bool SyncStore::IsOwner(SyncType type, int player_id,
+                        const PlayerID &player) const {
+  if (player_id < 0 || player_id >= PR_MAX_PLAYERS ||
+      player.binaryAddress == UNASSIGNED_PLAYER_ID.binaryAddress) {
+    return false;
+  }
+
+  const auto &owner = owners_[type][player_id];
+
+  return owner.binaryAddress == player.binaryAddress &&
+         owner.port == player.port;
+}
+
+void SyncStore::ReadBits(BitStream &bs, std::uint8_t &value,
+                         int number_of_bits) {
+  value = 0;
+
+  bs.ReadBits(&value, number_of_bits, true);
+}
+
+void SyncStore::Put(cell *&data, float value) { *data++ = amx_ftoc(value); }
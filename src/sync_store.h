@@ -0,0 +1,223 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PAWNRAKNET_SYNC_STORE_H_
+#define PAWNRAKNET_SYNC_STORE_H_
+
+// The last incoming on-foot, in-car, passenger, aim and bullet sync of every
+// player, decoded once when the packet leaves the Receive hook. Each field is
+// kept in its own array indexed by player id, so a lookup of one field for
+// many players touches only that field's memory
+class SyncStore {
+ public:
+  enum SyncType {
+    kOnFoot,
+    kInCar,
+    kPassenger,
+    kAim,
+    kBullet,
+
+    kNumberOfSyncTypes
+  };
+
+  template <typename T>
+  using PerPlayer = std::array<T, PR_MAX_PLAYERS>;
+
+  using Vector3 = std::array<float, 3>;
+  using Quaternion = std::array<float, 4>;
+
+  struct OnFoot {
+    PerPlayer<std::uint16_t> lr_key;
+    PerPlayer<std::uint16_t> ud_key;
+    PerPlayer<std::uint16_t> keys;
+    PerPlayer<Vector3> position;
+    PerPlayer<Quaternion> quaternion;
+    PerPlayer<std::uint8_t> health;
+    PerPlayer<std::uint8_t> armour;
+    PerPlayer<std::uint8_t> additional_key;
+    PerPlayer<std::uint8_t> weapon_id;
+    PerPlayer<std::uint8_t> special_action;
+    PerPlayer<Vector3> velocity;
+    PerPlayer<Vector3> surfing_offsets;
+    PerPlayer<std::uint16_t> surfing_vehicle_id;
+    PerPlayer<std::int16_t> animation_id;
+    PerPlayer<std::int16_t> animation_flags;
+  };
+
+  struct InCar {
+    PerPlayer<std::uint16_t> vehicle_id;
+    PerPlayer<std::uint16_t> lr_key;
+    PerPlayer<std::uint16_t> ud_key;
+    PerPlayer<std::uint16_t> keys;
+    PerPlayer<Quaternion> quaternion;
+    PerPlayer<Vector3> position;
+    PerPlayer<Vector3> velocity;
+    PerPlayer<float> vehicle_health;
+    PerPlayer<std::uint8_t> player_health;
+    PerPlayer<std::uint8_t> armour;
+    PerPlayer<std::uint8_t> additional_key;
+    PerPlayer<std::uint8_t> weapon_id;
+    PerPlayer<std::uint8_t> siren_state;
+    PerPlayer<std::uint8_t> landing_gear_state;
+    PerPlayer<std::uint16_t> trailer_id;
+    PerPlayer<float> train_speed;
+  };
+
+  // Decodes the packet if it is one of the stored syncs, returns its type
+  // (kNumberOfSyncTypes if it isn't stored)
+  SyncType Update(const Packet &packet);
+
+  // Position of the last kOnFoot, kInCar or kPassenger sync, velocity of the
+  // last kOnFoot or kInCar one
+  const Vector3 &GetPosition(SyncType type, int player_id) const;
+
+  const Vector3 &GetVelocity(SyncType type, int player_id) const;
+
+  // Position of the newest on-foot, in-car or passenger sync of the player.
+  // False if there is none
+  bool GetLastPosition(int player_id, const PlayerID &player,
+                       Vector3 &position) const;
+
+  // Read-only views of the on-foot and in-car arrays, valid for the players
+  // GetOnFootSync/GetInCarSync would succeed for
+  const OnFoot &GetOnFoot() const;
+
+  const InCar &GetInCar() const;
+
+  // Copy the last sync of the player into data laid out like the
+  // PR_OnFootSync, PR_InCarSync, ... enums. False if nothing has been
+  // received from this player (or from the one who had the id before)
+  bool GetOnFootSync(int player_id, const PlayerID &player, cell *data) const;
+
+  bool GetInCarSync(int player_id, const PlayerID &player, cell *data) const;
+
+  bool GetPassengerSync(int player_id, const PlayerID &player,
+                        cell *data) const;
+
+  bool GetAimSync(int player_id, const PlayerID &player, cell *data) const;
+
+  bool GetBulletSync(int player_id, const PlayerID &player, cell *data) const;
+
+ private:
+  static constexpr unsigned char kVehicleSyncId = 200;
+  static constexpr unsigned char kAimSyncId = 203;
+  static constexpr unsigned char kBulletSyncId = 206;
+  static constexpr unsigned char kPlayerSyncId = 207;
+  static constexpr unsigned char kPassengerSyncId = 211;
+
+  // size of the incoming layouts, the packet id included
+  static constexpr unsigned int kOnFootSyncBits = 552;
+  static constexpr unsigned int kInCarSyncBits = 512;
+  static constexpr unsigned int kPassengerSyncBits = 200;
+  static constexpr unsigned int kAimSyncBits = 256;
+  static constexpr unsigned int kBulletSyncBits = 328;
+
+  struct Passenger {
+    PerPlayer<std::uint16_t> vehicle_id;
+    PerPlayer<std::uint8_t> drive_by;
+    PerPlayer<std::uint8_t> seat_id;
+    PerPlayer<std::uint8_t> additional_key;
+    PerPlayer<std::uint8_t> weapon_id;
+    PerPlayer<std::uint8_t> player_health;
+    PerPlayer<std::uint8_t> player_armour;
+    PerPlayer<std::uint16_t> lr_key;
+    PerPlayer<std::uint16_t> ud_key;
+    PerPlayer<std::uint16_t> keys;
+    PerPlayer<Vector3> position;
+  };
+
+  struct Aim {
+    PerPlayer<std::uint8_t> cam_mode;
+    PerPlayer<Vector3> cam_front_vec;
+    PerPlayer<Vector3> cam_pos;
+    PerPlayer<float> aim_z;
+    PerPlayer<std::uint8_t> weapon_state;
+    PerPlayer<std::uint8_t> cam_zoom;
+    PerPlayer<std::uint8_t> aspect_ratio;
+  };
+
+  struct Bullet {
+    PerPlayer<std::uint8_t> hit_type;
+    PerPlayer<std::uint16_t> hit_id;
+    PerPlayer<Vector3> origin;
+    PerPlayer<Vector3> hit_pos;
+    PerPlayer<Vector3> offsets;
+    PerPlayer<std::uint8_t> weapon_id;
+  };
+
+  template <typename T>
+  static void Read(BitStream &bs, T &value) {
+    bs.Read(value);
+  }
+
+  template <std::size_t N>
+  static void Read(BitStream &bs, std::array<float, N> &value) {
+    for (auto &component : value) {
+      bs.Read(component);
+    }
+  }
+
+  static void ReadBits(BitStream &bs, std::uint8_t &value, int number_of_bits);
+
+  template <typename T>
+  static void Put(cell *&data, T value) {
+    *data++ = static_cast<cell>(value);
+  }
+
+  static void Put(cell *&data, float value);
+
+  template <std::size_t N>
+  static void Put(cell *&data, const std::array<float, N> &value) {
+    for (const auto component : value) {
+      Put(data, component);
+    }
+  }
+
+  void UpdateOnFoot(int player_id, BitStream &bs);
+
+  void UpdateInCar(int player_id, BitStream &bs);
+
+  void UpdatePassenger(int player_id, BitStream &bs);
+
+  void UpdateAim(int player_id, BitStream &bs);
+
+  void UpdateBullet(int player_id, BitStream &bs);
+
+  bool IsOwner(SyncType type, int player_id, const PlayerID &player) const;
+
+  OnFoot on_foot_{};
+  InCar in_car_{};
+  Passenger passenger_{};
+  Aim aim_{};
+  Bullet bullet_{};
+
+  // who sent the stored data, so that the next player with the id doesn't
+  // get it
+  std::array<PerPlayer<PlayerID>, kNumberOfSyncTypes> owners_{};
+
+  // which of the syncs has the newest position
+  PerPlayer<SyncType> position_types_{};
+};
+
+#endif  // PAWNRAKNET_SYNC_STORE_H_
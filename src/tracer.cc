@@ -0,0 +1,128 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "main.h"
+
+void Tracer::Start() { started_ = true; }
+
+void Tracer::Stop() { started_ = false; }
+
+const char *Tracer::Intern(const std::string &name) {
+  const std::lock_guard lock{mutex_};
+
+  return names_.insert(name).first->c_str();
+}
+
+std::size_t Tracer::Flush(const std::string &file_path) {
+  // opened first, so the spans stay buffered if the file can't be written
+  std::ofstream file{file_path, std::ofstream::trunc};
+  if (!file) {
+    throw std::runtime_error{"Can't open " + file_path};
+  }
+
+  std::vector<std::pair<std::size_t /* thread_id */, Event>> events;
+
+  {
+    const std::lock_guard lock{mutex_};
+
+    for (const auto &buffer : buffers_) {
+      const std::lock_guard buffer_lock{buffer->mutex};
+
+      const auto capacity = buffer->events.size();
+      const auto first = (buffer->next + capacity - buffer->size) % capacity;
+
+      for (std::size_t i{}; i < buffer->size; i++) {
+        events.emplace_back(buffer->thread_id,
+                            buffer->events[(first + i) % capacity]);
+      }
+
+      buffer->size = 0;
+    }
+  }
+
+  file << R"({"displayTimeUnit":"ms","traceEvents":[)";
+
+  bool first{true};
+
+  for (const auto &[thread_id, event] : events) {
+    if (!first) {
+      file << ',';
+    }
+    first = false;
+
+    file << R"({"ph":"X","pid":1,"tid":)" << thread_id << R"(,"name":")";
+
+    for (auto c = event.name ? event.name : ""; *c; c++) {
+      if (*c == '"' || *c == '\\') {
+        file << '\\';
+      }
+      file << *c;
+    }
+
+    file << R"(","ts":)" << event.start
+         << R"(,"dur":)" << event.end - event.start << R"(,"args":{"id":)"
+         << event.id << R"(,"player":)" << event.player_id << "}}";
+  }
+
+  file << "]}\n";
+
+  return events.size();
+}
+
+std::int64_t Tracer::Now() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void Tracer::Record(const char *name, int id, int player_id,
+                    std::int64_t start, std::int64_t end) {
+  auto &buffer = GetThreadBuffer();
+
+  const std::lock_guard lock{buffer.mutex};
+
+  buffer.events[buffer.next] = {name, id, player_id, start, end};
+
+  buffer.next = (buffer.next + 1) % buffer.events.size();
+  if (buffer.size < buffer.events.size()) {
+    buffer.size++;
+  }
+}
+
+Tracer::ThreadBuffer &Tracer::GetThreadBuffer() {
+  thread_local std::shared_ptr<ThreadBuffer> buffer;
+
+  if (!buffer) {
+    buffer = std::make_shared<ThreadBuffer>();
+    buffer->events.resize(kEventsPerThread);
+
+    const std::lock_guard lock{mutex_};
+
+    buffer->thread_id = buffers_.size() + 1;
+
+    buffers_.push_back(buffer);
+  }
+
+  return *buffer;
+}
@@ -0,0 +1,109 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PAWNRAKNET_TRACER_H_
+#define PAWNRAKNET_TRACER_H_
+
+// Records spans of the hot paths into per-thread rings while it is started,
+// and writes them out as a Chrome trace (chrome://tracing, ui.perfetto.dev)
+class Tracer {
+ public:
+  // Records the time between its construction and destruction. Costs one
+  // atomic load while the tracer is stopped
+  class Span {
+   public:
+    Span(Tracer &tracer, const char *name, int id = -1, int player_id = -1)
+        : tracer_{tracer},
+          name_{name},
+          id_{id},
+          player_id_{player_id},
+          start_{tracer.IsStarted() ? Now() : -1} {}
+
+    Span(const Span &) = delete;
+    Span &operator=(const Span &) = delete;
+
+    ~Span() {
+      if (start_ != -1) {
+        tracer_.Record(name_, id_, player_id_, start_, Now());
+      }
+    }
+
+   private:
+    Tracer &tracer_;
+    const char *name_{};
+    int id_{};
+    int player_id_{};
+    std::int64_t start_{};
+  };
+
+  static constexpr std::size_t kEventsPerThread = 65536;
+
+  void Start();
+
+  void Stop();
+
+  bool IsStarted() const {
+    return started_.load(std::memory_order_relaxed);
+  }
+
+  // A copy of the name that lives as long as the tracer, for spans named
+  // after things that may go away before the flush (publics)
+  const char *Intern(const std::string &name);
+
+  // Moves the recorded spans into the file, returns the number of spans
+  std::size_t Flush(const std::string &file_path);
+
+  // Microseconds of the steady clock
+  static std::int64_t Now();
+
+ private:
+  struct Event {
+    const char *name{};
+    int id{};
+    int player_id{};
+    std::int64_t start{};
+    std::int64_t end{};
+  };
+
+  struct ThreadBuffer {
+    std::mutex mutex;  // only contended by Flush
+    std::vector<Event> events;
+    std::size_t next{};
+    std::size_t size{};
+    std::size_t thread_id{};
+  };
+
+  void Record(const char *name, int id, int player_id, std::int64_t start,
+              std::int64_t end);
+
+  ThreadBuffer &GetThreadBuffer();
+
+  std::atomic_bool started_{};
+
+  std::mutex mutex_;
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+  std::unordered_set<std::string> names_;
+};
+
+#endif  // PAWNRAKNET_TRACER_H_
@@ -0,0 +1,212 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PAWNRAKNET_PACKET_INJECTOR_H_
+#define PAWNRAKNET_PACKET_INJECTOR_H_
+
+// Header-only producer for the injection channel (POSIX). Any number of
+// injectors, in any number of processes, may push at once:
+//
+//   PacketInjector injector{"pawnraknet"};  // InjectionChannelName
+//
+//   injector.SendRPC(playerid, 93, data, number_of_bits);  // ClientMessage
+//
+// Every call returns false if the channel is full; the server runs at most
+// InjectionChannelTickLimit entries per tick. The server removes the channel
+// when it shuts down or the config changes, so an injector that runs across
+// server restarts has to open it again.
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../../src/injection_channel_layout.h"
+
+class PacketInjector {
+ public:
+  // RakNet priorities and reliabilities, see Pawn.RakNet.inc
+  static constexpr std::uint8_t kHighPriority = 1;
+  static constexpr std::uint8_t kReliableOrdered = 9;
+
+  explicit PacketInjector(const std::string &name) {
+    const auto shm_name = "/" + name;
+
+    const int fd = shm_open(shm_name.c_str(), O_RDWR, 0);
+    if (fd == -1) {
+      throw std::runtime_error{"shm_open failed for " + shm_name};
+    }
+
+    struct stat file_stat {};
+    if (fstat(fd, &file_stat) != 0 ||
+        static_cast<std::size_t>(file_stat.st_size) <
+            sizeof(InjectionChannelHeader)) {
+      close(fd);
+
+      throw std::runtime_error{shm_name + " is not an injection channel"};
+    }
+
+    mapping_size_ = file_stat.st_size;
+
+    auto mapping = mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE,
+                        MAP_SHARED, fd, 0);
+
+    close(fd);
+
+    if (mapping == MAP_FAILED) {
+      throw std::runtime_error{"mmap failed for " + shm_name};
+    }
+
+    header_ = static_cast<InjectionChannelHeader *>(mapping);
+
+    if (header_->magic != kInjectionChannelMagic ||
+        header_->version != kInjectionChannelVersion ||
+        header_->header_size +
+                std::size_t{header_->slot_count} * header_->slot_size >
+            mapping_size_) {
+      munmap(mapping, mapping_size_);
+
+      throw std::runtime_error{shm_name + " has an unsupported layout"};
+    }
+
+    slots_ = static_cast<unsigned char *>(mapping) + header_->header_size;
+  }
+
+  PacketInjector(const PacketInjector &) = delete;
+  PacketInjector &operator=(const PacketInjector &) = delete;
+
+  ~PacketInjector() { munmap(header_, mapping_size_); }
+
+  // player_id kInjectionBroadcast sends to everyone
+  bool SendPacket(std::uint16_t player_id, const void *data,
+                  std::uint32_t number_of_bits,
+                  std::uint8_t priority = kHighPriority,
+                  std::uint8_t reliability = kReliableOrdered,
+                  std::uint8_t ordering_channel = 0) {
+    return Push(kInjectionSendPacket, 0, player_id, data, number_of_bits,
+                priority, reliability, ordering_channel);
+  }
+
+  bool SendRPC(std::uint16_t player_id, std::uint8_t rpc_id, const void *data,
+               std::uint32_t number_of_bits,
+               std::uint8_t priority = kHighPriority,
+               std::uint8_t reliability = kReliableOrdered,
+               std::uint8_t ordering_channel = 0) {
+    return Push(kInjectionSendRPC, rpc_id, player_id, data, number_of_bits,
+                priority, reliability, ordering_channel);
+  }
+
+  bool EmulatePacket(std::uint16_t player_id, const void *data,
+                     std::uint32_t number_of_bits) {
+    return Push(kInjectionEmulatePacket, 0, player_id, data, number_of_bits,
+                kHighPriority, kReliableOrdered, 0);
+  }
+
+  bool EmulateRPC(std::uint16_t player_id, std::uint8_t rpc_id,
+                  const void *data, std::uint32_t number_of_bits) {
+    return Push(kInjectionEmulateRPC, rpc_id, player_id, data, number_of_bits,
+                kHighPriority, kReliableOrdered, 0);
+  }
+
+  std::uint32_t GetMaxPayloadSize() const {
+    return header_->slot_size - sizeof(InjectionSlot);
+  }
+
+  // Entries the server has run, rejected and throttled (sends dropped or
+  // deferred by the bandwidth budget) since the channel was opened
+  std::uint32_t GetProcessed() const {
+    return header_->processed.load(std::memory_order_relaxed);
+  }
+
+  std::uint32_t GetRejected() const {
+    return header_->rejected.load(std::memory_order_relaxed);
+  }
+
+  std::uint32_t GetThrottled() const {
+    return header_->throttled.load(std::memory_order_relaxed);
+  }
+
+ private:
+  bool Push(InjectionCommand command, std::uint8_t id,
+            std::uint16_t player_id, const void *data,
+            std::uint32_t number_of_bits, std::uint8_t priority,
+            std::uint8_t reliability, std::uint8_t ordering_channel) {
+    const std::uint32_t size = (number_of_bits + 7) >> 3;
+    if (!size || size > GetMaxPayloadSize()) {
+      throw std::invalid_argument{"Invalid payload size"};
+    }
+
+    const auto slot_count = header_->slot_count;
+
+    auto pos = header_->enqueue_pos.load(std::memory_order_relaxed);
+
+    InjectionSlot *slot{};
+
+    for (;;) {
+      slot = reinterpret_cast<InjectionSlot *>(
+          slots_ + std::size_t{pos & (slot_count - 1)} * header_->slot_size);
+
+      const auto sequence = slot->sequence.load(std::memory_order_acquire);
+      const auto difference = static_cast<std::int32_t>(sequence - pos);
+
+      if (difference < 0) {
+        return false;
+      }
+
+      if (difference == 0 && header_->enqueue_pos.compare_exchange_weak(
+                                 pos, pos + 1, std::memory_order_relaxed)) {
+        break;
+      }
+
+      if (difference > 0) {
+        pos = header_->enqueue_pos.load(std::memory_order_relaxed);
+      }
+    }
+
+    slot->command = command;
+    slot->id = id;
+    slot->priority = priority;
+    slot->reliability = reliability;
+    slot->ordering_channel = ordering_channel;
+    slot->reserved = 0;
+    slot->player_id = player_id;
+    slot->number_of_bits = number_of_bits;
+
+    std::memcpy(reinterpret_cast<unsigned char *>(slot + 1), data, size);
+
+    slot->sequence.store(pos + 1, std::memory_order_release);
+
+    return true;
+  }
+
+  InjectionChannelHeader *header_{};
+  unsigned char *slots_{};
+  std::size_t mapping_size_{};
+};
+
+#endif  // PAWNRAKNET_PACKET_INJECTOR_H_
@@ -0,0 +1,73 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Prints the records of a packet tap:
+//   g++ -std=c++17 -O2 dump.cc -o packet_tap_dump -lrt
+//   ./packet_tap_dump pawnraknet
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#include "packet_tap_reader.h"
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    std::fprintf(stderr, "usage: %s <PacketTapName>\n", argv[0]);
+
+    return 1;
+  }
+
+  try {
+    PacketTapReader reader{argv[1]};
+
+    std::uint32_t dropped{};
+
+    for (;;) {
+      const auto record = reader.Peek();
+      if (!record) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+
+        continue;
+      }
+
+      std::printf("%llu type %u id %u player %u bits %u\n",
+                  static_cast<unsigned long long>(record->time_us),
+                  record->type, record->id, record->player_id,
+                  record->number_of_bits);
+
+      reader.Pop();
+
+      if (reader.GetDropped() != dropped) {
+        dropped = reader.GetDropped();
+
+        std::printf("dropped %u\n", dropped);
+      }
+    }
+  } catch (const std::exception &e) {
+    std::fprintf(stderr, "%s\n", e.what());
+
+    return 1;
+  }
+}
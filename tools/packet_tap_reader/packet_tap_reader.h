@@ -0,0 +1,165 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PAWNRAKNET_PACKET_TAP_READER_H_
+#define PAWNRAKNET_PACKET_TAP_READER_H_
+
+// Header-only reader of the packet tap ring (POSIX). Records are read in
+// place from the shared memory:
+//
+//   PacketTapReader reader{"pawnraknet"};  // PacketTapName from the config
+//
+//   while (const auto record = reader.Peek()) {
+//     Analyze(*record, PacketTapReader::GetPayload(record));
+//
+//     reader.Pop();  // the record and its payload are reused after this
+//   }
+//
+// The server removes the ring when it shuts down or the config changes, so
+// a reader that runs across server restarts has to open it again.
+
+#include <stdexcept>
+#include <string>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../../src/packet_tap_layout.h"
+
+class PacketTapReader {
+ public:
+  explicit PacketTapReader(const std::string &name) {
+    const auto shm_name = "/" + name;
+
+    const int fd = shm_open(shm_name.c_str(), O_RDWR, 0);
+    if (fd == -1) {
+      throw std::runtime_error{"shm_open failed for " + shm_name};
+    }
+
+    struct stat file_stat {};
+    if (fstat(fd, &file_stat) != 0 ||
+        static_cast<std::size_t>(file_stat.st_size) <
+            sizeof(PacketTapHeader)) {
+      close(fd);
+
+      throw std::runtime_error{shm_name + " is not a packet tap"};
+    }
+
+    mapping_size_ = file_stat.st_size;
+
+    auto mapping = mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE,
+                        MAP_SHARED, fd, 0);
+
+    close(fd);
+
+    if (mapping == MAP_FAILED) {
+      throw std::runtime_error{"mmap failed for " + shm_name};
+    }
+
+    header_ = static_cast<PacketTapHeader *>(mapping);
+
+    if (header_->magic != kPacketTapMagic ||
+        header_->version != kPacketTapVersion ||
+        header_->header_size + header_->capacity > mapping_size_) {
+      munmap(mapping, mapping_size_);
+
+      throw std::runtime_error{shm_name + " has an unsupported layout"};
+    }
+
+    data_ = static_cast<unsigned char *>(mapping) + header_->header_size;
+  }
+
+  PacketTapReader(const PacketTapReader &) = delete;
+  PacketTapReader &operator=(const PacketTapReader &) = delete;
+
+  ~PacketTapReader() { munmap(header_, mapping_size_); }
+
+  // The next record, or nullptr if the ring is empty
+  const PacketTapRecord *Peek() {
+    const auto capacity = header_->capacity;
+
+    auto read_pos = header_->read_pos.load(std::memory_order_relaxed);
+
+    while (read_pos != header_->write_pos.load(std::memory_order_acquire)) {
+      const auto offset = read_pos & (capacity - 1);
+
+      if (capacity - offset < sizeof(PacketTapRecord)) {
+        read_pos += capacity - offset;
+
+        continue;
+      }
+
+      const auto record =
+          reinterpret_cast<const PacketTapRecord *>(data_ + offset);
+      if (record->type == kPacketTapPaddingType) {
+        read_pos += record->size;
+
+        continue;
+      }
+
+      header_->read_pos.store(read_pos, std::memory_order_release);
+
+      current_ = record;
+
+      return record;
+    }
+
+    header_->read_pos.store(read_pos, std::memory_order_release);
+
+    current_ = nullptr;
+
+    return nullptr;
+  }
+
+  // Gives the record returned by Peek back to the writer
+  void Pop() {
+    if (!current_) {
+      return;
+    }
+
+    header_->read_pos.fetch_add(current_->size, std::memory_order_release);
+
+    current_ = nullptr;
+  }
+
+  // Records the writer has lost because the ring was full
+  std::uint32_t GetDropped() const {
+    return header_->dropped.load(std::memory_order_relaxed);
+  }
+
+  static const unsigned char *GetPayload(const PacketTapRecord *record) {
+    return reinterpret_cast<const unsigned char *>(record + 1);
+  }
+
+ private:
+  PacketTapHeader *header_{};
+  unsigned char *data_{};
+  std::size_t mapping_size_{};
+
+  const PacketTapRecord *current_{};
+};
+
+#endif  // PAWNRAKNET_PACKET_TAP_READER_H_
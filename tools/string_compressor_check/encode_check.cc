@@ -0,0 +1,155 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Checks that HuffmanEncodingTree::EncodeArrayDirect writes the same bits as
+// EncodeArray at every start bit offset, for random frequency tables (from
+// flat to as skewed as an unsigned int allows) and the English table, on
+// random strings and on the strings of the given files, one per line:
+//   g++ -std=c++17 -O2 -I../../lib encode_check.cc ../../lib/RakNet/*.cpp
+//   ./a.out chat.txt
+//
+// Exits with 1 if any output differs.
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "RakNet/BitStream.h"
+#include "RakNet/DS_HuffmanEncodingTree.h"
+
+extern unsigned int englishCharacterFrequencies[256];
+
+std::vector<std::vector<unsigned int>> MakeTables(std::mt19937 &random) {
+  std::vector<std::vector<unsigned int>> tables;
+
+  tables.emplace_back(englishCharacterFrequencies,
+                      englishCharacterFrequencies + 256);
+
+  for (int i = 0; i < 32; i++) {
+    std::vector<unsigned int> table(256);
+
+    for (std::size_t c{}; c < table.size(); c++) {
+      switch (i % 4) {
+        case 0:  // flat
+          table[c] = 1;
+          break;
+        case 1:  // random
+          table[c] = random() % 1000;
+          break;
+        case 2:  // a few common bytes, the rest rare
+          table[c] = c % 17 ? random() % 4 : 100000 + random() % 100000;
+          break;
+        default:  // the longest codes the sum of an unsigned int allows
+          table[c] = c < 31 ? 1u << c : 0;
+          break;
+      }
+    }
+
+    tables.push_back(std::move(table));
+  }
+
+  return tables;
+}
+
+bool IsSame(const BitStream &a, const BitStream &b) {
+  return a.GetNumberOfBitsUsed() == b.GetNumberOfBitsUsed() &&
+         !std::memcmp(a.GetData(), b.GetData(), a.GetNumberOfBytesUsed());
+}
+
+int main(int argc, char *argv[]) {
+  std::mt19937 random{1};
+
+  std::vector<std::string> strings;
+
+  for (int i = 1; i < argc; i++) {
+    std::ifstream file{argv[i], std::ios::binary};
+    if (!file) {
+      std::fprintf(stderr, "can't open %s\n", argv[i]);
+
+      return 1;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+      strings.push_back(line);
+    }
+  }
+
+  for (int i = 0; i < 2000; i++) {
+    std::string str(i % 100 ? random() % 300 : random() % 10000, '\0');
+    for (auto &c : str) {
+      c = static_cast<char>(random());
+    }
+
+    strings.push_back(std::move(str));
+  }
+
+  std::size_t cases{}, failed{};
+
+  for (const auto &table : MakeTables(random)) {
+    HuffmanEncodingTree tree;
+    tree.GenerateFromFrequencyTable(table.data());
+
+    for (const auto &str : strings) {
+      const auto input = reinterpret_cast<const unsigned char *>(str.data());
+      const auto size = static_cast<unsigned>(str.size());
+
+      for (int offset = 0; offset < 16; offset++) {
+        BitStream expected, actual;
+
+        // whatever was written before, so the partial byte matters
+        for (int bit = 0; bit < offset; bit++) {
+          if (random() & 1) {
+            expected.Write1();
+            actual.Write1();
+          } else {
+            expected.Write0();
+            actual.Write0();
+          }
+        }
+
+        BitStream encoded;
+        tree.EncodeArray(input, size, &encoded);
+        expected.WriteBits(encoded.GetData(), encoded.GetNumberOfBitsUsed(),
+                           false);
+
+        tree.EncodeArrayDirect(input, size,
+                               tree.GetEncodedBitLength(input, size), &actual);
+
+        cases++;
+
+        if (!IsSame(expected, actual)) {
+          failed++;
+        }
+      }
+    }
+  }
+
+  std::printf("%zu cases, %zu differ\n", cases, failed);
+
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,105 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Round-trips strings through one StringCompressor from several threads at
+// once, switching between two languages, and compares the result with the
+// input. Build it with ThreadSanitizer to check that sharing one instance
+// needs no locks:
+//   g++ -std=c++17 -O1 -g -fsanitize=thread -I../../lib thread_check.cc
+//     ../../lib/RakNet/*.cpp
+//   ./a.out
+//
+// Exits with 1 if any string doesn't come back as it was written.
+
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "RakNet/BitStream.h"
+#include "RakNet/StringCompressor.h"
+
+int main() {
+  constexpr int kNumberOfThreads = 8;
+  constexpr int kNumberOfRounds = 20;
+
+  std::mt19937 random{1};
+
+  std::array<unsigned int, 256> table{};
+  for (auto &frequency : table) {
+    frequency = random() % 1000;
+  }
+
+  const StringCompressor compressor{{{1, table}}};
+
+  std::vector<std::string> strings(500);
+  for (auto &str : strings) {
+    str.resize(random() % 200);
+
+    for (auto &c : str) {
+      c = static_cast<char>(1 + random() % 255);
+    }
+  }
+
+  std::atomic_size_t failed{};
+  std::vector<std::thread> threads;
+
+  for (int i = 0; i < kNumberOfThreads; i++) {
+    threads.emplace_back([&, i] {
+      std::vector<char> decoded;
+
+      for (int round = 0; round < kNumberOfRounds; round++) {
+        const int language_id = (i + round) % 2;
+
+        for (const auto &str : strings) {
+          BitStream bs;
+
+          compressor.EncodeString(str.c_str(), 0, &bs, language_id);
+
+          decoded.assign(str.size() + 1, 0);
+          compressor.DecodeString(decoded.data(),
+                                  static_cast<int>(decoded.size()), &bs,
+                                  language_id);
+
+          if (str != decoded.data()) {
+            failed++;
+          }
+        }
+      }
+    });
+  }
+
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  std::printf("%d threads, %zu strings, %zu failed\n", kNumberOfThreads,
+              kNumberOfThreads * kNumberOfRounds * strings.size(),
+              failed.load());
+
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,185 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016-2023 katursis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Builds a PR_CSTRING frequency table for LanguageTables in the config from
+// captured strings, one per line, and compares the compressed size of the
+// strings with the English table:
+//   g++ -std=c++17 -O2 -I../../lib train.cc ../../lib/RakNet/*.cpp -o train
+//   ./train cp1251.freq chat.txt dialogs.txt
+//
+// Every 10th string is left out of the table and measured separately, which
+// is closer to what the table does for strings it hasn't seen.
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "RakNet/BitStream.h"
+#include "RakNet/StringCompressor.h"
+
+using Counts = std::array<std::uint64_t, 256>;
+
+// The tree sums the frequencies in an unsigned int and counts 0 as 1
+std::array<unsigned int, 256> MakeTable(const Counts &counts) {
+  constexpr std::uint64_t kMaxSum =
+      (std::numeric_limits<unsigned int>::max)() - 256;
+
+  std::uint64_t sum{};
+  for (const auto count : counts) {
+    sum += count;
+  }
+
+  const auto divisor = sum > kMaxSum ? sum / kMaxSum + 1 : 1;
+
+  std::array<unsigned int, 256> table{};
+  for (std::size_t i{}; i < counts.size(); i++) {
+    table[i] = static_cast<unsigned int>(
+        counts[i] ? (std::max)(counts[i] / divisor, std::uint64_t{1}) : 0);
+  }
+
+  return table;
+}
+
+std::uint64_t CountBits(const StringCompressor &compressor,
+                        const std::vector<std::string> &strings,
+                        int language_id) {
+  std::uint64_t bits{};
+  BitStream bs;
+  std::vector<char> decoded;
+
+  for (const auto &str : strings) {
+    bs.Reset();
+
+    compressor.EncodeString(str.c_str(), 0, &bs, language_id);
+
+    bits += bs.GetNumberOfBitsUsed();
+
+    decoded.assign(str.size() + 1, 0);
+    compressor.DecodeString(decoded.data(), static_cast<int>(decoded.size()),
+                            &bs, language_id);
+    if (str != decoded.data()) {
+      std::fprintf(stderr, "round trip failed: %s\n", str.c_str());
+    }
+  }
+
+  return bits;
+}
+
+void Report(const StringCompressor &compressor, const char *name,
+            const std::vector<std::string> &strings) {
+  std::uint64_t bytes{};
+  for (const auto &str : strings) {
+    bytes += str.size();
+  }
+
+  const auto english = CountBits(compressor, strings, 0);
+  const auto trained = CountBits(compressor, strings, 1);
+
+  std::printf("%s: %zu strings, %llu bytes, english %llu bits, "
+              "trained %llu bits (%.1f%%)\n",
+              name, strings.size(), static_cast<unsigned long long>(bytes),
+              static_cast<unsigned long long>(english),
+              static_cast<unsigned long long>(trained),
+              english ? 100.0 * trained / english : 100.0);
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 3) {
+    std::fprintf(stderr, "usage: %s <table> <strings>...\n", argv[0]);
+
+    return 1;
+  }
+
+  std::vector<std::string> training, held_out;
+  Counts training_counts{}, counts{};
+
+  for (int i = 2; i < argc; i++) {
+    std::ifstream file{argv[i], std::ios::binary};
+    if (!file) {
+      std::fprintf(stderr, "can't open %s\n", argv[i]);
+
+      return 1;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+      if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+      }
+
+      // EncodeString stops at the first 0
+      line.erase(std::find(line.begin(), line.end(), '\0'), line.end());
+
+      if (line.empty()) {
+        continue;
+      }
+
+      const bool is_held_out = (training.size() + held_out.size()) % 10 == 9;
+
+      for (const auto c : line) {
+        counts[static_cast<unsigned char>(c)]++;
+
+        if (!is_held_out) {
+          training_counts[static_cast<unsigned char>(c)]++;
+        }
+      }
+
+      (is_held_out ? held_out : training).push_back(line);
+    }
+  }
+
+  if (training.empty()) {
+    std::fprintf(stderr, "no strings\n");
+
+    return 1;
+  }
+
+  const StringCompressor compressor{{{1, MakeTable(training_counts)}}};
+
+  Report(compressor, "training", training);
+  Report(compressor, "held out", held_out);
+
+  const auto table = MakeTable(counts);
+
+  std::ofstream output{argv[1]};
+  if (!output) {
+    std::fprintf(stderr, "can't open %s\n", argv[1]);
+
+    return 1;
+  }
+
+  output << "# made by string_table_trainer from "
+         << training.size() + held_out.size() << " strings\n";
+
+  for (std::size_t i{}; i < table.size(); i++) {
+    output << table[i] << (i % 16 == 15 ? '\n' : ' ');
+  }
+
+  return 0;
+}